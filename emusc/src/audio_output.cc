@@ -19,10 +19,20 @@
 
 #include "audio_output.h"
 
+#include "audio_output_alsa.h"
+#include "audio_output_jack.h"
+#include "audio_output_pulse.h"
+#include "audio_output_wav.h"
+#include "audio_output_win32.h"
+#include "audio_output_core.h"
+#include "audio_output_qt.h"
+#include "audio_output_null.h"
+
 
 AudioOutput::AudioOutput(EmuSC::Synth *synth)
   : _quit(false),
     _synth(synth),
+    _meter(NULL),
     _volume(1.0f),
     _accLeft(0),
     _accRight(0),
@@ -36,6 +46,72 @@ AudioOutput::~AudioOutput()
 {}
 
 
+// Create audio output for the given audio system name, as stored in the
+// "Audio/system" setting
+AudioOutput *AudioOutput::create(QString audioSystem, EmuSC::Synth *synth)
+{
+  AudioOutput *audioOutput = NULL;
+
+  if (!audioSystem.compare("alsa", Qt::CaseInsensitive)) {
+#ifdef __ALSA_AUDIO__
+    audioOutput = new AudioOutputAlsa(synth);
+#else
+    throw(QString("'Alsa' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("jack", Qt::CaseInsensitive)) {
+#ifdef __JACK_AUDIO__
+    audioOutput = new AudioOutputJack(synth);
+#else
+    throw(QString("'JACK' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("pulse", Qt::CaseInsensitive)) {
+#ifdef __PULSE_AUDIO__
+    audioOutput = new AudioOutputPulse(synth);
+#else
+    throw(QString("'Pulse' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("qt", Qt::CaseInsensitive)) {
+#ifdef __QT_AUDIO__
+    audioOutput = new AudioOutputQt(synth);
+#else
+    throw(QString("'Qt' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("win32", Qt::CaseInsensitive)) {
+#ifdef __WIN32_AUDIO__
+    audioOutput = new AudioOutputWin32(synth);
+#else
+    throw(QString("'Win32' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("wav", Qt::CaseInsensitive)) {
+#ifdef __WAV_AUDIO__
+    audioOutput = new AudioOutputWav(synth);
+#else
+    throw(QString("'WAV' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("core audio", Qt::CaseInsensitive)) {
+#ifdef __CORE_AUDIO__
+    audioOutput = new AudioOutputCore(synth);
+#else
+    throw(QString("'Core Audio' audio ouput is missing in this build"));
+#endif
+
+  } else if (!audioSystem.compare("null", Qt::CaseInsensitive)) {
+    audioOutput = new AudioOutputNull(synth);
+  }
+
+  if (audioOutput == NULL)
+    throw(QString("Unknown audio system"));
+
+  return audioOutput;
+}
+
+
 void AudioOutput::_publish_levels(void)
 {
   if (_meter && _accNum > 0)
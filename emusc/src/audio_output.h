@@ -29,6 +29,8 @@
 #include <atomic>
 #include <cmath>
 
+#include <QString>
+
 
 class AudioOutput
 {
@@ -36,6 +38,8 @@ public:
   AudioOutput(EmuSC::Synth *synth);
   virtual ~AudioOutput() = 0;
 
+  static AudioOutput *create(QString audioSystem, EmuSC::Synth *synth);
+
   virtual void start(void) = 0;
   virtual void stop(void) = 0;
 
@@ -68,6 +72,28 @@ protected:
       _publish_levels();
   }
 
+  // Render a block of frames including stems (see EmuSC::Synth::Stem). Volume
+  // is only applied to the main output.
+  inline void _get_block(float *lOut, float *rOut, int frames,
+                         float **stemsL, float **stemsR)
+  {
+    _synth->render_block(lOut, rOut, frames, stemsL, stemsR);
+
+    const float volume = _volume.load(std::memory_order_relaxed);
+    for (int i = 0; i < frames; i++) {
+      lOut[i] *= volume;
+      rOut[i] *= volume;
+
+      _accLeft += lOut[i] * lOut[i];
+      _accRight += rOut[i] * rOut[i];
+      _accPeakLeft = std::max(_accPeakLeft, std::fabs(lOut[i]));
+      _accPeakRight = std::max(_accPeakRight, std::fabs(rOut[i]));
+
+      if (++_accNum >= 512)
+        _publish_levels();
+    }
+  }
+
 private:
   EmuSC::Synth *_synth;
 
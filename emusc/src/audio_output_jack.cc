@@ -25,12 +25,18 @@
 #include <iostream>
 #include <string>
 
+#include <QSettings>
+
 
 AudioOutputJack::AudioOutputJack(EmuSC::Synth *synth)
   : AudioOutput(synth),
+    _stems(false),
     _sampleRate(44100),
     _channels(2)
 {
+  QSettings settings;
+  _stems = settings.value("Audio/jack_stems").toBool();
+
   const char *server_name = NULL;
 
   jack_options_t options = JackNullOption;
@@ -55,18 +61,27 @@ AudioOutputJack::AudioOutputJack(EmuSC::Synth *synth)
   jack_on_shutdown(_client, shutdown, this);
 
   // TODO: Search for available ports and verify that we have CHANNELS available
-  for (int i = 0; i < _channels; i ++) {
-    std::string output = "output_" + std::to_string(i+1);
-
-    _port[i] = jack_port_register(_client, output.c_str(),
-				  JACK_DEFAULT_AUDIO_TYPE,
-				  JackPortIsOutput, 0);
-    if (_port[i] == NULL)
-      throw(std::string("No more JACK ports available"));
+  for (int i = 0; i < _channels; i ++)
+    _port[i] = _register_port("output_" + std::to_string(i+1));
+
+  if (_stems) {
+    for (int s = 0; s < _numStems; s++) {
+      std::string name;
+      if (s == (int) EmuSC::Synth::Stem::ChorusReturn)
+        name = "chorus_return";
+      else if (s == (int) EmuSC::Synth::Stem::ReverbReturn)
+        name = "reverb_return";
+      else
+        name = "part_" + std::to_string(s + 1);
+
+      _stemPort[s][0] = _register_port(name + "_L");
+      _stemPort[s][1] = _register_port(name + "_R");
+    }
   }
 
   _sampleRate = jack_get_sample_rate(_client);
   synth->set_audio_format(_sampleRate, _channels);
+  synth->set_stem_output(_stems);
 
   std::cout << "EmuSC: Audio output [JACK] successfully initialized ("
 	    << _sampleRate << " Hz)" << std::endl;
@@ -80,6 +95,18 @@ AudioOutputJack::~AudioOutputJack()
 }
 
 
+jack_port_t *AudioOutputJack::_register_port(std::string name)
+{
+  jack_port_t *port = jack_port_register(_client, name.c_str(),
+                                         JACK_DEFAULT_AUDIO_TYPE,
+                                         JackPortIsOutput, 0);
+  if (port == NULL)
+    throw(std::string("No more JACK ports available"));
+
+  return port;
+}
+
+
 int AudioOutputJack::callback(jack_nframes_t nframes, void *arg)
 {
   AudioOutputJack *aoj = (AudioOutputJack *) arg;
@@ -97,6 +124,24 @@ int AudioOutputJack::_fill_buffer(jack_nframes_t nframes)
     out[i] = (jack_default_audio_sample_t *) jack_port_get_buffer(_port[i],
 								  nframes);
 
+  // Stems are rendered directly into the JACK port buffers
+  if (_stems) {
+    float *stemsL[EmuSC::Synth::numStems];
+    float *stemsR[EmuSC::Synth::numStems];
+
+    for (int s = 0; s < EmuSC::Synth::numStems; s++) {
+      if (s < _numStems) {
+        stemsL[s] = (float *) jack_port_get_buffer(_stemPort[s][0], nframes);
+        stemsR[s] = (float *) jack_port_get_buffer(_stemPort[s][1], nframes);
+      } else {
+        stemsL[s] = stemsR[s] = NULL;
+      }
+    }
+
+    _get_block(out[0], out[1], nframes, stemsL, stemsR);
+    return 0;
+  }
+
   for (unsigned int frame = 0; frame < nframes; frame++) {
     _get_frame(fsample[0], fsample[1]);
 
@@ -31,6 +31,8 @@
 
 #include <jack/jack.h>
 
+#include <string>
+
 
 class AudioOutputJack: public AudioOutput
 {
@@ -38,9 +40,17 @@ private:
   jack_port_t *_port[2];
   jack_client_t *_client;
 
+  // Optional stem outputs: One stereo port pair for each part and effect
+  // return (sends are not exported)
+  static const int _numStems = (int) EmuSC::Synth::Stem::ReverbReturn + 1;
+  jack_port_t *_stemPort[_numStems][2];
+  bool _stems;
+
   int _channels;
   unsigned int _sampleRate;
 
+  jack_port_t *_register_port(std::string name);
+
   int _fill_buffer(jack_nframes_t nframes);
 
   void _shutdown(void);
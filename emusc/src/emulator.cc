@@ -27,23 +27,6 @@
 #include <QFile>
 #include <QSettings>
 
-#include "audio_output_alsa.h"
-#include "audio_output_jack.h"
-#include "audio_output_pulse.h"
-#include "audio_output_wav.h"
-#include "audio_output_win32.h"
-#include "audio_output_core.h"
-#include "audio_output_qt.h"
-#include "audio_output_null.h"
-
-#include "midi_input_alsa.h"
-#include "midi_input_core.h"
-#include "midi_input_win32.h"
-
-
-#include "envelope_dialog.h"
-#include "lfo_dialog.h"
-
 
 Emulator::Emulator(Scene *scene)
   : _scene(scene),
@@ -55,10 +38,16 @@ Emulator::Emulator(Scene *scene)
     _updateROMs(false),
     _selectedPart(0),
     _allMode(false),
-    _running(false)
+    _running(false),
+    _numMidiMessages(0)
 {
   _lcdDisplay = new LcdDisplay(scene, &_emuscSynth, &_emuscControlRom);
 
+  // MIDI activity LED polls the message counters, see _poll_midi_activity()
+  _midiActTimer = new QTimer(this);
+  _midiActTimer->setTimerType(Qt::CoarseTimer);
+  connect(_midiActTimer, SIGNAL(timeout()), this, SLOT(_poll_midi_activity()));
+
   _connect_signals();
 }
 
@@ -138,6 +127,10 @@ void Emulator::_connect_signals(void)
 
   connect(this, SIGNAL(part_changed(int)),
           this, SLOT(update_active_part_LCD_display(int)));
+
+  // Part modifications are reported from the MIDI thread
+  connect(this, SIGNAL(part_modified(int)),
+          this, SLOT(_part_modified(int)), Qt::QueuedConnection);
 }
 
 
@@ -172,6 +165,7 @@ void Emulator::start(void)
 
   try {
     _emuscSynth = new EmuSC::Synth(*_emuscControlRom, *_emuscWaveRom, _soundMap);
+    _paramSnapshot.version = 0;
 
     _start_audio_subsystem();
     _start_midi_subsystem();
@@ -184,12 +178,8 @@ void Emulator::start(void)
   _scene->set_model_name(_emuscControlRom->model().data(),
                          _emuscControlRom->version().data());
 
-  connect(_midiInput, SIGNAL(new_midi_message(bool, int)),
-	  _scene, SLOT(update_midi_activity_led(bool, int)));
-
-  // Also relay signals for new MIDI messages for status bar
-  connect(_midiInput, SIGNAL(new_midi_message(bool, int)),
-          this, SIGNAL(new_midi_message(bool, int)));
+  _numMidiMessages = get_num_midi_messages();
+  _midiActTimer->start(50);
 
   emit midi_port_changed(_midiInput->get_port_name());
 
@@ -211,6 +201,7 @@ void Emulator::stop(void)
   _emuscSynth->clear_part_midi_mod_callback();
   _emuscSynth->clear_part_change_callback();
 
+  _midiActTimer->stop();
   _lcdDisplay->turn_off();
 
   emit midi_port_changed(QString());
@@ -308,50 +299,25 @@ void Emulator::lcd_display_init_complete(void)
 }
 
 
-void Emulator::set_envelope_callback(int partId, EnvelopeDialog *dialog)
-{
-#ifdef __USE_QTCHARTS__
-  _emuscSynth->set_part_envelope_callback(partId,
-                                          std::bind(&EnvelopeDialog::envelope_callback,
-                                                    dialog,
-                                                    std::placeholders::_1,
-                                                    std::placeholders::_2,
-                                                    std::placeholders::_3,
-                                                    std::placeholders::_4,
-                                                    std::placeholders::_5,
-                                                    std::placeholders::_6));
-#endif
-}
-
-
-void Emulator::clear_envelope_callback(int partId)
+// Envelopes and LFOs are polled by the monitor dialogs at their own rate
+int Emulator::get_part_telemetry(int partId, uint64_t &pos,
+                                 EmuSC::Synth::PartTelemetry *data, int size)
 {
-  if (_emuscSynth)
-    _emuscSynth->clear_part_envelope_callback(partId);
-}
-
+  if (!_emuscSynth)
+    return 0;
 
-void Emulator::set_lfo_callback(int partId, LFODialog *dialog)
-{
-#ifdef __USE_QTCHARTS__
-  _emuscSynth->set_part_lfo_callback(partId,
-                                     std::bind(&LFODialog::lfo_callback,
-                                               dialog,
-                                               std::placeholders::_1,
-                                               std::placeholders::_2,
-                                               std::placeholders::_3));
-#endif
+  return _emuscSynth->get_part_telemetry(partId, pos, data, size);
 }
 
 
-void Emulator::clear_lfo_callback(int partId)
+// Called from the MIDI thread, so only forward to the GUI thread
+void Emulator::_part_mod_callback(const int partId)
 {
-  if (_emuscSynth)
-    _emuscSynth->clear_part_lfo_callback(partId);
+  emit part_modified(partId);
 }
 
 
-void Emulator::_part_mod_callback(const int partId)
+void Emulator::_part_modified(int partId)
 {
   if (partId == _selectedPart && !_allMode)
     _set_part(partId);
@@ -360,6 +326,19 @@ void Emulator::_part_mod_callback(const int partId)
 }
 
 
+// Unlike the rate limited new_midi_message signal this also catches the last
+// messages in a burst
+void Emulator::_poll_midi_activity(void)
+{
+  uint32_t numMessages = get_num_midi_messages();
+  if (numMessages == _numMidiMessages)
+    return;
+
+  _numMidiMessages = numMessages;
+  _scene->update_midi_activity_led(false, 0);
+}
+
+
 void Emulator::_part_change_callback(const int partId)
 {
   emit part_changed(partId);
@@ -373,30 +352,7 @@ void Emulator::_start_midi_subsystem()
   QString midiDevice = settings.value("Midi/device").toString();
 
   try {	    
-    if (!midiSystem.compare("alsa", Qt::CaseInsensitive)) {
-#ifdef __ALSA_MIDI__
-      _midiInput = new MidiInputAlsa();
-#else
-      throw(QString("Alsa MIDI system is missing in this build"));
-#endif
-
-    } else if (!midiSystem.compare("core midi", Qt::CaseInsensitive)) {
-#ifdef __CORE_MIDI__
-      _midiInput = new MidiInputCore();
-#else
-      throw(QString("Core MIDI system is missing in this build"));
-#endif
-
-    } else if (!midiSystem.compare("win32", Qt::CaseInsensitive)) {
-#ifdef __WIN32_MIDI__
-      _midiInput = new MidiInputWin32();
-#else
-      throw(QString("Win32 MIDI system is missing in this build"));
-#endif
-    } else {
-      throw(QString("No valid MIDI system configured. This can be done in the "
-		    "Preferences dialog."));
-    }
+    _midiInput = MidiInput::create(midiSystem);
   } catch (QString errorMsg) {
     throw(QString("Failed to initialize MIDI system (%1)\nError message: %3")
 	  .arg(midiSystem).arg(errorMsg));
@@ -417,61 +373,7 @@ void Emulator::_start_audio_subsystem(void)
   QString audioSystem = settings.value("Audio/system").toString();
 
   try {
-    if (!audioSystem.compare("alsa", Qt::CaseInsensitive)) {
-#ifdef __ALSA_AUDIO__
-      _audioOutput = new AudioOutputAlsa(_emuscSynth);
-#else
-      throw(QString("'Alsa' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("jack", Qt::CaseInsensitive)) {
-#ifdef __JACK_AUDIO__
-      _audioOutput = new AudioOutputJack(_emuscSynth);
-#else
-      throw(QString("'JACK' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("pulse", Qt::CaseInsensitive)) {
-#ifdef __PULSE_AUDIO__
-      _audioOutput = new AudioOutputPulse(_emuscSynth);
-#else
-      throw(QString("'Pulse' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("qt", Qt::CaseInsensitive)) {
-#ifdef __QT_AUDIO__
-      _audioOutput = new AudioOutputQt(_emuscSynth);
-#else
-      throw(QString("'Qt' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("win32", Qt::CaseInsensitive)) {
-#ifdef __WIN32_AUDIO__
-      _audioOutput = new AudioOutputWin32(_emuscSynth);
-#else
-      throw(QString("'Win32' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("wav", Qt::CaseInsensitive)) {
-#ifdef __WAV_AUDIO__
-      _audioOutput = new AudioOutputWav(_emuscSynth);
-#else
-      throw(QString("'WAV' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("core audio", Qt::CaseInsensitive)) {
-#ifdef __CORE_AUDIO__
-      _audioOutput = new AudioOutputCore(_emuscSynth);
-#else
-      throw(QString("'Core Audio' audio ouput is missing in this build"));
-#endif
-
-    } else if (!audioSystem.compare("null", Qt::CaseInsensitive)) {
-      _audioOutput = new AudioOutputNull(_emuscSynth);
-    }
-
-    if (_audioOutput == NULL)
-      throw(QString("Unknown audio system"));
+    _audioOutput = AudioOutput::create(audioSystem, _emuscSynth);
 
   } catch (QString errorMsg) {
     // Delete? stop()?
@@ -700,7 +602,7 @@ void Emulator::select_mute(bool mute)
   if (_allMode) {
     _emuscSynth->set_param(EmuSC::SystemParam::Mute, (uint8_t) mute);
   } else {
-    if (!_emuscSynth->get_param(EmuSC::SystemParam::Mute))
+    if (!get_param(EmuSC::SystemParam::Mute))
       // If "All mute" is active, ignore part mute updates
       _emuscSynth->set_param(EmuSC::PatchParam::Mute, mute, _selectedPart);
   }
@@ -737,16 +639,16 @@ void Emulator::_set_all(void)
   emit display_part_updated("ALL");
   emit display_instrument_updated("- SOUND Canvas -");
 
-  _set_level(_emuscSynth->get_param(EmuSC::SystemParam::Volume), false);
-  _set_pan(_emuscSynth->get_param(EmuSC::SystemParam::Pan), false);
-  _set_reverb(_emuscSynth->get_param(EmuSC::PatchParam::ReverbLevel), false);
-  _set_chorus(_emuscSynth->get_param(EmuSC::PatchParam::ChorusLevel), false);
-  _set_key_shift(_emuscSynth->get_param(EmuSC::SystemParam::KeyShift), false);
+  _set_level(get_param(EmuSC::SystemParam::Volume), false);
+  _set_pan(get_param(EmuSC::SystemParam::Pan), false);
+  _set_reverb(get_param(EmuSC::PatchParam::ReverbLevel), false);
+  _set_chorus(get_param(EmuSC::PatchParam::ChorusLevel), false);
+  _set_key_shift(get_param(EmuSC::SystemParam::KeyShift), false);
 
   emit display_midi_channel_updated(" 17");
 
   if (_allMode)
-    _scene->update_mute_button(_emuscSynth->get_param(EmuSC::SystemParam::Mute));
+    _scene->update_mute_button(get_param(EmuSC::SystemParam::Mute));
 }
 
 
@@ -761,25 +663,25 @@ void Emulator::_set_part(uint8_t value)
   str.prepend(' ');
   _lcdDisplay->set_part(str);
 
-  uint8_t *toneNumber =
-    _emuscSynth->get_param_ptr(EmuSC::PatchParam::ToneNumber, value);
+  const uint8_t *toneNumber =
+    get_param_ptr(EmuSC::PatchParam::ToneNumber, value);
   _set_instrument(toneNumber[1], toneNumber[0], false);
-  _set_level(_emuscSynth->get_param(EmuSC::PatchParam::PartLevel, value),false);
-  _set_pan(_emuscSynth->get_param(EmuSC::PatchParam::PartPanpot, value), false);
-  _set_reverb(_emuscSynth->get_param(EmuSC::PatchParam::ReverbSendLevel, value),
+  _set_level(get_param(EmuSC::PatchParam::PartLevel, value),false);
+  _set_pan(get_param(EmuSC::PatchParam::PartPanpot, value), false);
+  _set_reverb(get_param(EmuSC::PatchParam::ReverbSendLevel, value),
 	      false);
-  _set_chorus(_emuscSynth->get_param(EmuSC::PatchParam::ChorusSendLevel, value),
+  _set_chorus(get_param(EmuSC::PatchParam::ChorusSendLevel, value),
 	      false);
-  _set_key_shift(_emuscSynth->get_param(EmuSC::PatchParam::PitchKeyShift,value),
+  _set_key_shift(get_param(EmuSC::PatchParam::PitchKeyShift,value),
 		 false);
-  _set_midi_channel(_emuscSynth->get_param(EmuSC::PatchParam::RxChannel, value),
+  _set_midi_channel(get_param(EmuSC::PatchParam::RxChannel, value),
 		    false);
 
   // TODO: Should be handled by signal / slot when part changes or new part
   // is selected in display
   if (!_allMode)
-    _scene->update_mute_button(_emuscSynth->get_param(EmuSC::PatchParam::Mute,
-                                                      _selectedPart));
+    _scene->update_mute_button(get_param(EmuSC::PatchParam::Mute,
+					 _selectedPart));
 }
 
 
@@ -788,14 +690,14 @@ void Emulator::select_prev_instrument()
   if (!_emuscSynth || _allMode)
     return;
 
-  uint8_t *toneNumber =
-    _emuscSynth->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
+  const uint8_t *toneNumber =
+    get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
   uint8_t bank = toneNumber[0];
   uint8_t index = toneNumber[1];
   _set_instrument(index, bank, false);
 
   // Instrument
-  if (!_emuscSynth->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
+  if (!get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
     const std::array<uint16_t, 128> &var = _emuscControlRom->variation(bank);
     for (int i = index - 1; i >= 0; i--) {
       if (var[i] != 0xffff) {
@@ -823,14 +725,14 @@ void Emulator::select_next_instrument()
   if (!_emuscSynth || _allMode)
     return;
 
-  uint8_t *toneNumber =
-    _emuscSynth->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
+  const uint8_t *toneNumber =
+    get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
   uint8_t bank = toneNumber[0];
   uint8_t index = toneNumber[1];
   _set_instrument(index, bank, false);
 
   // Instrument
-  if (!_emuscSynth->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
+  if (!get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
     const std::array<uint16_t, 128> &var = _emuscControlRom->variation(bank);
     for (int i = index + 1; i < (int) var.size(); i++) {
       if (var[i] != 0xffff) {
@@ -858,13 +760,13 @@ void Emulator::select_next_instrument_variant()
   if (!_emuscSynth || _allMode)
     return;
 
-  uint8_t *toneNumber =
-    _emuscSynth->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
+  const uint8_t *toneNumber =
+    get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
   uint8_t bank = toneNumber[0];
   uint8_t index = toneNumber[1];
 
   // Only relevant for instrument, not drums
-  if (!_emuscSynth->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
+  if (!get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
     for (int i = bank + 1; i < 128; i++) {
       const std::array<uint16_t, 128> &var = _emuscControlRom->variation(i);
       if (var[index] != 0xffff) {
@@ -881,13 +783,13 @@ void Emulator::select_prev_instrument_variant()
   if (!_emuscSynth || _allMode)
     return;
 
-  uint8_t *toneNumber =
-    _emuscSynth->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
+  const uint8_t *toneNumber =
+    get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
   uint8_t bank = toneNumber[0];
   uint8_t index = toneNumber[1];
 
   // Only relevant for instrument, not drums
-  if (!_emuscSynth->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
+  if (!get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart)) {
     for (int i = bank - 1; i >= 0; i--) {
       const std::array<uint16_t, 128> &var = _emuscControlRom->variation(i);
       if (var[index] != 0xffff) {
@@ -906,7 +808,7 @@ void Emulator::_set_instrument(uint8_t index, uint8_t bank, bool update)
 
   QString str;
   uint8_t rhythm =
-    _emuscSynth->get_param(EmuSC::PatchParam::UseForRhythm,_selectedPart);
+    get_param(EmuSC::PatchParam::UseForRhythm,_selectedPart);
   if (!rhythm) {
     if (update)
       _emuscSynth->set_part_instrument(_selectedPart, index, bank);
@@ -944,10 +846,10 @@ void Emulator::select_prev_level(void)
   uint8_t currentLevel;
 
   if (_allMode)
-    currentLevel = _emuscSynth->get_param(EmuSC::SystemParam::Volume);
+    currentLevel = get_param(EmuSC::SystemParam::Volume);
   else
-    currentLevel = _emuscSynth->get_param(EmuSC::PatchParam::PartLevel,
-					  _selectedPart);
+    currentLevel = get_param(EmuSC::PatchParam::PartLevel,
+			     _selectedPart);
 
   if (currentLevel > 0)
     _set_level(currentLevel - 1, true);
@@ -962,10 +864,10 @@ void Emulator::select_next_level(void)
   uint8_t currentLevel;
 
   if (_allMode)
-    currentLevel = _emuscSynth->get_param(EmuSC::SystemParam::Volume);
+    currentLevel = get_param(EmuSC::SystemParam::Volume);
   else
-    currentLevel = _emuscSynth->get_param(EmuSC::PatchParam::PartLevel,
-					  _selectedPart);
+    currentLevel = get_param(EmuSC::PatchParam::PartLevel,
+			     _selectedPart);
 
   if (currentLevel < 127)
     _set_level(currentLevel + 1, true);
@@ -997,10 +899,10 @@ void Emulator::select_prev_pan()
   uint8_t currentPan;
 
   if (_allMode)
-    currentPan = _emuscSynth->get_param(EmuSC::SystemParam::Pan);
+    currentPan = get_param(EmuSC::SystemParam::Pan);
   else
-    currentPan = _emuscSynth->get_param(EmuSC::PatchParam::PartPanpot,
-					      _selectedPart);
+    currentPan = get_param(EmuSC::PatchParam::PartPanpot,
+			   _selectedPart);
 
   if ((_allMode && currentPan > 1) || (!_allMode && currentPan > 0))
     _set_pan(currentPan - 1, true);
@@ -1015,10 +917,10 @@ void Emulator::select_next_pan()
   uint8_t currentPan;;
 
   if (_allMode)
-    currentPan = _emuscSynth->get_param(EmuSC::SystemParam::Pan);
+    currentPan = get_param(EmuSC::SystemParam::Pan);
   else
-    currentPan = _emuscSynth->get_param(EmuSC::PatchParam::PartPanpot,
-					      _selectedPart);
+    currentPan = get_param(EmuSC::PatchParam::PartPanpot,
+			   _selectedPart);
 
   if (currentPan < 127)
     _set_pan(currentPan + 1, true);
@@ -1059,10 +961,10 @@ void Emulator::select_prev_reverb()
   uint8_t currentReverb;
 
   if (_allMode)
-    currentReverb =_emuscSynth->get_param(EmuSC::PatchParam::ReverbLevel);
+    currentReverb =get_param(EmuSC::PatchParam::ReverbLevel);
   else
-    currentReverb = _emuscSynth->get_param(EmuSC::PatchParam::ReverbSendLevel,
-					   _selectedPart);
+    currentReverb = get_param(EmuSC::PatchParam::ReverbSendLevel,
+			      _selectedPart);
 
   if (currentReverb > 0)
     _set_reverb(currentReverb - 1, true);
@@ -1077,10 +979,10 @@ void Emulator::select_next_reverb()
   uint8_t currentReverb;
 
   if (_allMode)
-    currentReverb =_emuscSynth->get_param(EmuSC::PatchParam::ReverbLevel);
+    currentReverb =get_param(EmuSC::PatchParam::ReverbLevel);
   else
-    currentReverb = _emuscSynth->get_param(EmuSC::PatchParam::ReverbSendLevel,
-					   _selectedPart);
+    currentReverb = get_param(EmuSC::PatchParam::ReverbSendLevel,
+			      _selectedPart);
 
   if (currentReverb < 127)
     _set_reverb(currentReverb + 1, true);
@@ -1113,10 +1015,10 @@ void Emulator::select_prev_chorus()
   uint8_t currentChorus;
 
   if (_allMode)
-    currentChorus =_emuscSynth->get_param(EmuSC::PatchParam::ChorusLevel);
+    currentChorus =get_param(EmuSC::PatchParam::ChorusLevel);
   else
-    currentChorus = _emuscSynth->get_param(EmuSC::PatchParam::ChorusSendLevel,
-					   _selectedPart);
+    currentChorus = get_param(EmuSC::PatchParam::ChorusSendLevel,
+			      _selectedPart);
 
   if (currentChorus > 0)
     _set_chorus(currentChorus - 1, true);
@@ -1131,10 +1033,10 @@ void Emulator::select_next_chorus()
   uint8_t currentChorus;
 
   if (_allMode)
-    currentChorus =_emuscSynth->get_param(EmuSC::PatchParam::ChorusLevel);
+    currentChorus =get_param(EmuSC::PatchParam::ChorusLevel);
   else
-    currentChorus = _emuscSynth->get_param(EmuSC::PatchParam::ChorusSendLevel,
-					   _selectedPart);
+    currentChorus = get_param(EmuSC::PatchParam::ChorusSendLevel,
+			      _selectedPart);
 
   if (currentChorus < 127)
     _set_chorus(currentChorus + 1, true);
@@ -1167,10 +1069,10 @@ void Emulator::select_prev_key_shift()
   int8_t currentKeyShift;
 
   if (_allMode)
-    currentKeyShift = _emuscSynth->get_param(EmuSC::SystemParam::KeyShift);
+    currentKeyShift = get_param(EmuSC::SystemParam::KeyShift);
   else
-    currentKeyShift = _emuscSynth->get_param(EmuSC::PatchParam::PitchKeyShift,
-					     _selectedPart);
+    currentKeyShift = get_param(EmuSC::PatchParam::PitchKeyShift,
+				_selectedPart);
 
   if (currentKeyShift > 0x28)
     _set_key_shift(currentKeyShift - 1, true);
@@ -1185,10 +1087,10 @@ void Emulator::select_next_key_shift()
   int8_t currentKeyShift;
 
   if (_allMode)
-    currentKeyShift = _emuscSynth->get_param(EmuSC::SystemParam::KeyShift);
+    currentKeyShift = get_param(EmuSC::SystemParam::KeyShift);
   else
-    currentKeyShift = _emuscSynth->get_param(EmuSC::PatchParam::PitchKeyShift,
-					     _selectedPart);
+    currentKeyShift = get_param(EmuSC::PatchParam::PitchKeyShift,
+				_selectedPart);
 
   if (currentKeyShift < 0x58)
     _set_key_shift(currentKeyShift + 1, true);
@@ -1224,7 +1126,7 @@ void Emulator::select_prev_midi_channel()
     return;
 
   uint8_t currentMidiChannel =
-    _emuscSynth->get_param(EmuSC::PatchParam::RxChannel, _selectedPart);
+    get_param(EmuSC::PatchParam::RxChannel, _selectedPart);
   if (currentMidiChannel > 0)
     _set_midi_channel(currentMidiChannel - 1, true);
 }
@@ -1236,7 +1138,7 @@ void Emulator::select_next_midi_channel()
     return;
 
   uint8_t currentMidiChannel =
-    _emuscSynth->get_param(EmuSC::PatchParam::RxChannel, _selectedPart);
+    get_param(EmuSC::PatchParam::RxChannel, _selectedPart);
   if (currentMidiChannel < 16)
     _set_midi_channel(currentMidiChannel + 1, true);
 }
@@ -1278,60 +1180,60 @@ void Emulator::change_volume(int volume)
 
 uint8_t Emulator::get_param(enum EmuSC::SystemParam sp)
 {
-  return _emuscSynth->get_param(sp);
+  return _params().get_param(sp);
 }
 
-uint8_t* Emulator::get_param_ptr(enum EmuSC::SystemParam sp)
+const uint8_t* Emulator::get_param_ptr(enum EmuSC::SystemParam sp)
 {
-  return _emuscSynth->get_param_ptr(sp);
+  return _params().get_param_ptr(sp);
 }
 
 
 uint16_t Emulator::get_param_32nib(enum EmuSC::SystemParam sp)
 {
-  return _emuscSynth->get_param_32nib(sp);
+  return _params().get_param_32nib(sp);
 }
 
 
 uint8_t Emulator::get_param(enum EmuSC::PatchParam pp, int8_t part)
 {
-  return _emuscSynth->get_param(pp, part);
+  return _params().get_param(pp, part);
 }
 
 
-uint8_t* Emulator::get_param_ptr(enum EmuSC::PatchParam pp, int8_t part)
+const uint8_t* Emulator::get_param_ptr(enum EmuSC::PatchParam pp, int8_t part)
 {
-  return _emuscSynth->get_param_ptr(pp, part);
+  return _params().get_param_ptr(pp, part);
 }
 
 
 uint8_t Emulator::get_param_nib16(enum EmuSC::PatchParam pp, int8_t part)
 {
-  return _emuscSynth->get_param_nib16(pp, part);
+  return _params().get_param_nib16(pp, part);
 }
 
 
 uint16_t Emulator::get_param_uint14(enum EmuSC::PatchParam pp, int8_t part)
 {
-  return _emuscSynth->get_param_uint14(pp, part);
+  return _params().get_param_uint14(pp, part);
 }
 
 
 uint8_t Emulator::get_patch_param(uint16_t address, int8_t part)
 {
-  return _emuscSynth->get_patch_param(address, part);
+  return _params().get_patch_param(address, part);
 }
 
 
 uint8_t Emulator::get_param(enum EmuSC::DrumParam dp, uint8_t map, uint8_t key)
 {
-  return _emuscSynth->get_param(dp, map, key);
+  return _params().get_param(dp, map, key);
 }
 
 
-int8_t* Emulator::get_param_ptr(enum EmuSC::DrumParam dp, uint8_t map)
+const int8_t* Emulator::get_param_ptr(enum EmuSC::DrumParam dp, uint8_t map)
 {
-  return _emuscSynth->get_param_ptr(dp, map);
+  return _params().get_param_ptr(dp, map);
 }
 
 
@@ -1411,7 +1313,7 @@ void Emulator::play_note(uint8_t key, uint8_t velocity)
 }
 
 
-std::vector<EmuSC::ControlRom::DrumSet> &Emulator::get_drumsets_ref(void)
+const std::vector<EmuSC::ControlRom::DrumSet> &Emulator::get_drumsets_ref(void)
 {
   return _emuscControlRom->get_drumsets_ref();
 }
@@ -1483,7 +1385,7 @@ void Emulator::set_mt32_map(void)
 }
 
 
-EmuSC::ControlRom::Instrument &Emulator::get_instrument_rom(int bank, int index)
+const EmuSC::ControlRom::Instrument &Emulator::get_instrument_rom(int bank, int index)
 {
   if (!_emuscControlRom)
     throw (QString("No instrument available"));
@@ -38,8 +38,6 @@
 
 #include <inttypes.h>
 
-class EnvelopeDialog;
-class LFODialog;
 
 class Emulator : public QObject
 {
@@ -51,6 +49,11 @@ public:
 
   LevelMeter::Levels get_levels(void) { return _levelMeter.get_and_reset(); }
 
+  // Total number of MIDI events and SysEx messages received, for polling
+  uint32_t get_num_midi_messages(void)
+  { return _midiInput ? _midiInput->get_num_events() +
+                        _midiInput->get_num_sysex() : 0; }
+
   void start(void);
   void stop(void);
 
@@ -63,14 +66,14 @@ public:
   QString wave_rom_version(void);
   QString wave_rom_date(void);
 
-  EmuSC::ControlRom::Instrument &get_instrument_rom(int bank, int index);
+  const EmuSC::ControlRom::Instrument &get_instrument_rom(int bank, int index);
 
   QStandardItemModel *get_instruments_list(void);
   QStandardItemModel *get_partials_list(void);
   QStandardItemModel *get_samples_list(void);
 
   std::array<std::array<uint16_t, 128>, 128> get_variations_table(void);
-  std::vector<EmuSC::ControlRom::DrumSet> &get_drumsets_ref(void);
+  const std::vector<EmuSC::ControlRom::DrumSet> &get_drumsets_ref(void);
   std::array<uint8_t, 128> get_drumsets_LUT(void);
 
   int dump_demo_songs(QString path);
@@ -93,15 +96,15 @@ public:
 
   // libEmuSC Synth API for get & set paramters
   uint8_t  get_param(enum EmuSC::SystemParam sp);
-  uint8_t* get_param_ptr(enum EmuSC::SystemParam sp);
+  const uint8_t* get_param_ptr(enum EmuSC::SystemParam sp);
   uint16_t get_param_32nib(enum EmuSC::SystemParam sp);
   uint8_t  get_param(enum EmuSC::PatchParam pp, int8_t part = -1);
-  uint8_t* get_param_ptr(enum EmuSC::PatchParam pp, int8_t part = -1);
+  const uint8_t* get_param_ptr(enum EmuSC::PatchParam pp, int8_t part = -1);
   uint8_t  get_param_nib16(enum EmuSC::PatchParam pp, int8_t part = -1);
   uint16_t get_param_uint14(enum EmuSC::PatchParam pp, int8_t part = -1);
   uint8_t get_patch_param(uint16_t address, int8_t part);
   uint8_t  get_param(enum EmuSC::DrumParam, uint8_t map, uint8_t key);
-  int8_t* get_param_ptr(enum EmuSC::DrumParam, uint8_t map);
+  const int8_t* get_param_ptr(enum EmuSC::DrumParam, uint8_t map);
 
   void set_param(enum EmuSC::SystemParam sp, uint8_t value);
   void set_param(enum EmuSC::SystemParam sp, uint8_t *data, uint8_t size = 1);
@@ -122,10 +125,8 @@ public:
 
   int set_part_instrument(int part, int index, int bank);
 
-  void set_envelope_callback(int partId, EnvelopeDialog *dialog);
-  void clear_envelope_callback(int partId);
-  void set_lfo_callback(int partId, LFODialog *dialog);
-  void clear_lfo_callback(int partId);
+  int get_part_telemetry(int partId, uint64_t &pos,
+                         EmuSC::Synth::PartTelemetry *data, int size);
 
   int get_lfo_rate_LUT(int index);
   int get_lfo_delay_fade_LUT(int index);
@@ -150,8 +151,8 @@ signals:
   void mute_button_changed(bool state);
 
   void part_changed(int part);
+  void part_modified(int part);
 
-  void new_midi_message(bool sysEx, int length);
   void midi_port_changed(QString port);
 
   public slots:
@@ -201,6 +202,13 @@ private:
   EmuSC::WaveRom *_emuscWaveRom;
   EmuSC::Synth *_emuscSynth;
 
+  // All parameter reads go through this snapshot to avoid reading parameters
+  // while they are modified by the MIDI and audio threads. Only to be used by
+  // the GUI thread, so synth callbacks must be forwarded by queued signals.
+  EmuSC::Synth::ParamSnapshot _paramSnapshot;
+  inline const EmuSC::Synth::ParamSnapshot &_params(void) {
+    _emuscSynth->get_param_snapshot(_paramSnapshot); return _paramSnapshot; }
+
   AudioOutput *_audioOutput;
   MidiInput   *_midiInput;
 
@@ -220,6 +228,9 @@ private:
 
   bool _running;
 
+  QTimer *_midiActTimer;
+  uint32_t _numMidiMessages;
+
   EmuSC::Synth::SoundMap _soundMap;
 
   LevelMeter _levelMeter;
@@ -247,6 +258,10 @@ private:
 
   void _part_mod_callback(const int partId);
   void _part_change_callback(const int partId);
+
+private slots:
+  void _part_modified(int partId);
+  void _poll_midi_activity(void);
 };
 
 
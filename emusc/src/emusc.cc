@@ -17,9 +17,12 @@
  */
 
 
+#include "headless.h"
 #include "main_window.h"
 
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include <QApplication>
@@ -71,9 +74,22 @@ static QString loadQss(const QString& path)
 
 int main(int argc, char *argv[])
 {
-  QApplication app(argc, argv);
-  app.setWindowIcon(QIcon(":/icon-256.png"));
-  app.setStyleSheet(loadQss(":/styles/emusc.qss"));
+  // Headless mode must be known before creating the application object since
+  // QApplication requires a display
+  bool headless = false;
+  for (int i = 1; i < argc; i++)
+    if (!std::strcmp(argv[i], "--headless"))
+      headless = true;
+
+  std::unique_ptr<QCoreApplication> app;
+  if (headless) {
+    app.reset(new QCoreApplication(argc, argv));
+  } else {
+    QApplication *guiApp = new QApplication(argc, argv);
+    guiApp->setWindowIcon(QIcon(":/icon-256.png"));
+    guiApp->setStyleSheet(loadQss(":/styles/emusc.qss"));
+    app.reset(guiApp);
+  }
 
   QCoreApplication::setOrganizationName("emusc");
   QCoreApplication::setApplicationName("EmuSC");
@@ -93,6 +109,16 @@ int main(int argc, char *argv[])
                            "state", "");
   parser.addOption(power);
 
+  QCommandLineOption headlessOption(QStringList() << "headless",
+                                    "Run without user interface using the "
+                                    "stored configuration");
+  parser.addOption(headlessOption);
+
+  QCommandLineOption instance(QStringList() << "i" << "instance",
+                              "Use a separate configuration for this instance",
+                              "name", "");
+  parser.addOption(instance);
+
 #ifdef __ALSA_MIDI__
   QCommandLineOption midiPort(QStringList() << "m" << "midi-port",
                               "Connect to MIDI port (ALSA only)",
@@ -100,7 +126,11 @@ int main(int argc, char *argv[])
   parser.addOption(midiPort);
 #endif
 
-  parser.process(app);
+  parser.process(*app);
+
+  // QSettings are stored per application name
+  if (parser.isSet(instance))
+    QCoreApplication::setApplicationName("EmuSC-" + parser.value(instance));
 
   if (parser.isSet(power) &&
       !(!parser.value(power).compare("ON", Qt::CaseInsensitive) ||
@@ -122,11 +152,30 @@ int main(int argc, char *argv[])
   }
 #endif
 
+  if (headless) {
+    QString midiPortName;
+#ifdef __ALSA_MIDI__
+    midiPortName = parser.value(midiPort);
+#endif
+
+    Headless::install_signal_handlers();
+
+    Headless synth;
+    try {
+      synth.start(midiPortName);
+    } catch (QString errorMsg) {
+      std::cerr << "Error: " << errorMsg.toStdString() << std::endl;
+      return 1;
+    }
+
+    return app->exec();
+  }
+
   MainWindow window;
   window.show();
 
-  QApplication::connect(&app, SIGNAL(aboutToQuit()),
+  QApplication::connect(app.get(), SIGNAL(aboutToQuit()),
 			&window, SLOT(cleanUp()));
 
-  return app.exec();
+  return app->exec();
 }
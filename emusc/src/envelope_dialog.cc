@@ -26,7 +26,6 @@
 #include <vector>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QDialogButtonBox>
 #include <QFont>
 #include <QHBoxLayout>
@@ -39,8 +38,9 @@ EnvelopeDialog::EnvelopeDialog(Emulator *emulator, Scene *scene, QWidget *parent
     _scene(scene),
     _timePeriod(10),
     _selectedPart(0),
-    _callbackReceived(0),
-    _reset(0)
+    _telemetryPos(0),
+    _time(0),
+    _reset(true)
 {
   QObject::connect(&_chartTimer, &QTimer::timeout,
                    this, &EnvelopeDialog::chart_timeout);
@@ -186,14 +186,11 @@ EnvelopeDialog::EnvelopeDialog(Emulator *emulator, Scene *scene, QWidget *parent
   show();
 
   _chartTimer.start();
-
-  _emulator->set_envelope_callback(_selectedPart, this);
 }
 
 
 EnvelopeDialog::~EnvelopeDialog()
 {
-  _emulator->clear_envelope_callback(_selectedPart);
 }
 
 
@@ -255,91 +252,42 @@ void EnvelopeDialog::done(int res)
 // Update all charts at 10Hz
 void EnvelopeDialog::chart_timeout(void)
 {
-  if (!_callbackReceived) {
+  std::array<EmuSC::Synth::PartTelemetry, 256> data;
+  int num = _emulator->get_part_telemetry(_selectedPart, _telemetryPos,
+                                          data.data(), data.size());
+
+  // Restart charts on the first active note after a pause
+  bool active = false;
+  for (int i = 0; i < num; i++)
+    active |= data[i].active;
+
+  if (!active) {
     _reset = true;
     return;
 
-  } else {
-    if (_reset) {
-      _clear_series();
-      _reset = false;
-      _timeStart = -1;
-    }
-  }
+  } else if (_reset) {
+    _clear_series();
+    _reset = false;
+    _time = 0;
 
-  // Copy all the data to a temporary buffer to let the audio thread run
-  _dataMutex.lock();
-
-  std::vector<std::pair<float, qint64>> tvpData1(_tvpData1.constBegin(),
-                                                 _tvpData1.constEnd());
-  std::vector<std::pair<float, qint64>> tvpData2(_tvpData2.constBegin(),
-                                                 _tvpData2.constEnd());
-  std::vector<std::pair<float, qint64>> tvfData1(_tvfData1.constBegin(),
-                                                 _tvfData1.constEnd());
-  std::vector<std::pair<float, qint64>> tvfData2(_tvfData2.constBegin(),
-                                                 _tvfData2.constEnd());
-  std::vector<std::pair<float, qint64>> tvaData1(_tvaData1.constBegin(),
-                                                 _tvaData1.constEnd());
-  std::vector<std::pair<float, qint64>> tvaData2(_tvaData2.constBegin(),
-                                                 _tvaData2.constEnd());
-
-  _tvpData1.clear();
-  _tvpData2.clear();
-  _tvfData1.clear();
-  _tvfData2.clear();
-  _tvaData1.clear();
-  _tvaData2.clear();
-
-  _callbackReceived = false;
-
-  _dataMutex.unlock();
-
-  // Add T0 = 0 for TVA envelopes
-  if (_timeStart < 0) {
-    _timeStart = tvpData1[0].second - 1;
+    // Add T0 = 0 for TVA envelopes
     _tvaP1Series->append(0, 0);
     _tvaP2Series->append(0, 0);
   }
 
-  for (auto &value : tvpData1)
-    _tvpP1Series->append((value.second - _timeStart) / 1000.0, value.first);
-  for (auto &value : tvpData2)
-    _tvpP2Series->append((value.second - _timeStart) / 1000.0, value.first);
-
-  for (auto &value : tvfData1)
-    _tvfP1Series->append((value.second - _timeStart) / 1000.0,
-                         value.first / 1.28f);
-  for (auto &value : tvfData2)
-    _tvfP2Series->append((value.second - _timeStart) / 1000.0,
-                         value.first / 1.28f);
-
-  for (auto &value : tvaData1)
-    _tvaP1Series->append((value.second - _timeStart) / 1000.0,
-                         value.first / 2.56f);
-  for (auto &value : tvaData2)
-    _tvaP2Series->append((value.second - _timeStart) / 1000.0,
-                         value.first / 2.56f);
-}
+  for (int i = 0; i < num; i++) {
+    if (!data[i].active)
+      continue;
 
+    _time += 256 / 32000.0;                 // One control block per entry
 
-void EnvelopeDialog::envelope_callback(const float tvp1, const float tvp2,
-                                       const float tvf1, const float tvf2,
-                                       const float tva1, const float tva2)
-{
-  qint64 time = QDateTime::currentMSecsSinceEpoch();
-
-  _dataMutex.lock();
-
-  _tvpData1.push_back(std::make_pair(tvp1, time));
-  _tvpData2.push_back(std::make_pair(tvp2, time));
-  _tvfData1.push_back(std::make_pair(tvf1, time));
-  _tvfData2.push_back(std::make_pair(tvf2, time));
-  _tvaData1.push_back(std::make_pair(tva1, time));
-  _tvaData2.push_back(std::make_pair(tva2, time));
-
-  _dataMutex.unlock();
-
-  _callbackReceived = true;
+    _tvpP1Series->append(_time, data[i].pitch[0]);
+    _tvpP2Series->append(_time, data[i].pitch[1]);
+    _tvfP1Series->append(_time, data[i].tvf[0] / 1.28f);
+    _tvfP2Series->append(_time, data[i].tvf[1] / 1.28f);
+    _tvaP1Series->append(_time, data[i].tva[0] / 2.56f);
+    _tvaP2Series->append(_time, data[i].tva[1] / 2.56f);
+  }
 }
 
 
@@ -359,12 +307,11 @@ void EnvelopeDialog::keyReleaseEvent(QKeyEvent *keyEvent)
 
 void EnvelopeDialog::_partCB_changed(int value)
 {
-  _emulator->clear_envelope_callback(_selectedPart);
-
   _selectedPart = value;
+  _telemetryPos = 0;
+  _reset = true;
 
   _partCB->setCurrentIndex(_selectedPart);
-  _emulator->set_envelope_callback(_selectedPart, this);
   _part_changed(value);
 }
 
@@ -382,9 +329,9 @@ void EnvelopeDialog::_part_changed(int partId)
   uint8_t rhythm =
     _emulator->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart);
   if (!rhythm) {
-    uint8_t *tone =
+    const uint8_t *tone =
       _emulator->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
-    EmuSC::ControlRom::Instrument &iRom =
+    const EmuSC::ControlRom::Instrument &iRom =
       _emulator->get_instrument_rom(tone[0], tone[1]);
 
     _instrumentTitle->setText(QString::fromStdString(iRom.name));
@@ -27,7 +27,8 @@
 #include "emulator.h"
 #include "scene.h"
 
-#include <utility>
+#include <array>
+#include <cstdint>
 
 #include <QVector>
 #include <QPushButton>
@@ -35,7 +36,6 @@
 #include <QDialog>
 #include <QKeyEvent>
 #include <QLabel>
-#include <QMutex>
 #include <QTimer>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
@@ -55,10 +55,6 @@ public:
   EnvelopeDialog(Emulator *emulator, Scene *scene, QWidget *parent = nullptr);
   virtual ~EnvelopeDialog();
 
-  void envelope_callback(const float tvp1, const float tvp2,
-                         const float tvf1, const float tvf2,
-                         const float tva1, const float tva2);
-
 public slots:
   void chart_timeout(void);
 
@@ -70,17 +66,9 @@ private:
   Scene *_scene;
 
   QTimer _chartTimer;
-  QMutex _dataMutex;
 
   QLabel *_instrumentTitle;
 
-  QList<std::pair<float, qint64>> _tvpData1;
-  QList<std::pair<float, qint64>> _tvpData2;
-  QList<std::pair<float, qint64>> _tvfData1;
-  QList<std::pair<float, qint64>> _tvfData2;
-  QList<std::pair<float, qint64>> _tvaData1;
-  QList<std::pair<float, qint64>> _tvaData2;
-
   QChart *_tvpChart;
   QChart *_tvfChart;
   QChart *_tvaChart;
@@ -107,11 +95,11 @@ private:
   QComboBox *_envelopeCB;
 
   int _selectedPart;
+  uint64_t _telemetryPos;       // Read position in part telemetry
 
   int _timePeriod;
-  qint64 _timeStart;
+  double _time;                 // Seconds since first active envelope
 
-  bool _callbackReceived;
   bool _reset;
 
   void keyPressEvent(QKeyEvent *keyEvent);
@@ -0,0 +1,158 @@
+/*
+ *  This file is part of EmuSC, a Sound Canvas emulator
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  EmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  EmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with EmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "headless.h"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QStringList>
+
+
+static volatile std::sig_atomic_t quitRequested = 0;
+
+static void signal_handler(int)
+{
+  quitRequested = 1;
+}
+
+
+Headless::Headless(QObject *parent)
+  : QObject(parent),
+    _controlRom(NULL),
+    _waveRom(NULL),
+    _synth(NULL),
+    _audioOutput(NULL),
+    _midiInput(NULL)
+{
+  // Signal handlers can only set a flag, so check it at a low rate to keep
+  // the event loop idle
+  _quitTimer = new QTimer(this);
+  _quitTimer->setTimerType(Qt::VeryCoarseTimer);
+  connect(_quitTimer, SIGNAL(timeout()), this, SLOT(_check_quit()));
+  _quitTimer->start(500);
+}
+
+
+Headless::~Headless()
+{
+  stop();
+}
+
+
+void Headless::install_signal_handlers(void)
+{
+  std::signal(SIGINT, signal_handler);
+  std::signal(SIGTERM, signal_handler);
+}
+
+
+void Headless::_check_quit(void)
+{
+  if (quitRequested)
+    QCoreApplication::quit();
+}
+
+
+void Headless::start(QString midiPort)
+{
+  QSettings settings;
+
+  QString progPath = settings.value("Rom/prog").toString();
+  QString cpuPath = settings.value("Rom/cpu").toString();
+  if (progPath.isEmpty() || cpuPath.isEmpty())
+    throw(QString("Control ROMs (prog and CPU) are not configured"));
+
+  std::vector<std::string> waveRomPaths;
+  for (auto &key : QStringList({ "Rom/wave1", "Rom/wave2", "Rom/wave3" })) {
+    QString filePath = settings.value(key).toString();
+    if (!filePath.isEmpty())
+#ifdef Q_OS_WINDOWS
+      waveRomPaths.push_back(filePath.toLocal8Bit().constData());
+#else
+      waveRomPaths.push_back(filePath.toStdString());
+#endif
+  }
+
+  try {
+#ifdef Q_OS_WINDOWS
+    _controlRom = new EmuSC::ControlRom(progPath.toLocal8Bit().constData(),
+                                        cpuPath.toLocal8Bit().constData());
+#else
+    _controlRom = new EmuSC::ControlRom(progPath.toStdString(),
+                                        cpuPath.toStdString());
+#endif
+    _waveRom = new EmuSC::WaveRom(waveRomPaths, *_controlRom);
+    _synth = new EmuSC::Synth(*_controlRom, *_waveRom);
+
+  } catch (std::string errorMsg) {
+    stop();
+    throw(QString("libemusc failed to load ROMs: ") + errorMsg.c_str());
+  }
+
+  QString audioSystem = settings.value("Audio/system").toString();
+  QString midiSystem = settings.value("Midi/system").toString();
+
+  try {
+    _audioOutput = AudioOutput::create(audioSystem, _synth);
+    _audioOutput->set_volume(std::clamp(settings.value("Audio/volume", 80)
+                                        .toInt(), 0, 100) / 100.0);
+    _audioOutput->start();
+
+    _midiInput = MidiInput::create(midiSystem);
+    _midiInput->start(_synth, settings.value("Midi/device").toString());
+
+    if (!midiPort.isEmpty())
+      _midiInput->connect_port(midiPort, true);
+
+  } catch (QString errorMsg) {
+    stop();
+    throw(QString("Failed to start audio (%1) or MIDI (%2) system: %3")
+          .arg(audioSystem).arg(midiSystem).arg(errorMsg));
+  }
+
+  std::cout << "EmuSC: Running headless with " << _controlRom->model()
+            << " control ROM, audio system '" << audioSystem.toStdString()
+            << "' and MIDI system '" << midiSystem.toStdString() << "'"
+            << std::endl;
+}
+
+
+void Headless::stop(void)
+{
+  if (_midiInput)
+    delete _midiInput, _midiInput = NULL;
+
+  if (_audioOutput)
+    delete _audioOutput, _audioOutput = NULL;
+
+  if (_synth)
+    delete _synth, _synth = NULL;
+
+  if (_waveRom)
+    delete _waveRom, _waveRom = NULL;
+
+  if (_controlRom)
+    delete _controlRom, _controlRom = NULL;
+}
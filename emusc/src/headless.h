@@ -0,0 +1,67 @@
+/*
+ *  This file is part of EmuSC, a Sound Canvas emulator
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  EmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  EmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with EmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "emusc/control_rom.h"
+#include "emusc/synth.h"
+#include "emusc/wave_rom.h"
+
+#include "audio_output.h"
+#include "midi_input.h"
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+
+// Headless run mode: A synth connected to the configured MIDI input and audio
+// output without any user interface. Configuration is read from QSettings,
+// using the same keys as the GUI Preferences dialog.
+class Headless : public QObject
+{
+  Q_OBJECT
+
+public:
+  Headless(QObject *parent = nullptr);
+  virtual ~Headless();
+
+  void start(QString midiPort = QString());
+  void stop(void);
+
+  // Quit event loop on SIGINT / SIGTERM
+  static void install_signal_handlers(void);
+
+private slots:
+  void _check_quit(void);
+
+private:
+  EmuSC::ControlRom *_controlRom;
+  EmuSC::WaveRom *_waveRom;
+  EmuSC::Synth *_synth;
+
+  AudioOutput *_audioOutput;
+  MidiInput *_midiInput;
+
+  QTimer *_quitTimer;
+};
+
+
+#endif  // HEADLESS_H
@@ -52,7 +52,8 @@ LFODialog::LFODialog(Emulator *emulator, Scene *scene, QWidget *parent)
     _sampleHoldPM(":/images/wf_samplehold.png"),
     _randomPM(":/images/wf_random.png"),
     _timePeriod(3),
-    _selectedPart(0)
+    _selectedPart(0),
+    _telemetryPos(0)
 {
   // Convert black waveform icons to white if we are using dark mode
 #if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
@@ -187,8 +188,6 @@ LFODialog::LFODialog(Emulator *emulator, Scene *scene, QWidget *parent)
 	  this, SLOT(_timeCB_changed(QString)));
   connect(_emulator, SIGNAL(part_changed(int)),
 	  this, SLOT(_part_changed(int)));
-  connect(this, SIGNAL(lfo_data_received(int, int, int)),
-          this, SLOT(_update_lfo_series(int, int, int)));
 
   QVBoxLayout *mainLayout = new QVBoxLayout;
   mainLayout->addWidget(chartView, 1);
@@ -213,14 +212,11 @@ LFODialog::LFODialog(Emulator *emulator, Scene *scene, QWidget *parent)
   _lfo2p2Buf.reserve(lfoBufferSize);
 
   _chartTimer.start();
-
-  _emulator->set_lfo_callback(_selectedPart, this);
 }
 
 
 LFODialog::~LFODialog()
 {
-  _emulator->clear_lfo_callback(_selectedPart);
 }
 
 
@@ -241,19 +237,18 @@ void LFODialog::done(int res)
 // QTimer interval: 25ms => 40Hz
 void LFODialog::chart_timeout(void)
 {
+  std::array<EmuSC::Synth::PartTelemetry, 256> data;
+  int num = _emulator->get_part_telemetry(_selectedPart, _telemetryPos,
+                                          data.data(), data.size());
+  for (int i = 0; i < num; i++)
+    _update_lfo_series(data[i].lfo[0], data[i].lfo[1], data[i].lfo[2]);
+
   _LFO1Series->replace(_lfo1Buf);
   _LFO2P1Series->replace(_lfo2p1Buf);
   _LFO2P2Series->replace(_lfo2p2Buf);
 }
 
 
-// Called from emulator thread
-void LFODialog::lfo_callback(const int lfo1, const int lfo2p1, const int lfo2p2)
-{
-  emit lfo_data_received(lfo1, lfo2p1, lfo2p2);
-}
-
-
 void LFODialog::_update_lfo_series(const int lfo1,
                                    const int lfo2p1, const int lfo2p2)
 {
@@ -300,12 +295,10 @@ void LFODialog::keyReleaseEvent(QKeyEvent *keyEvent)
 
 void LFODialog::_partCB_changed(int value)
 {
-  _emulator->clear_lfo_callback(_selectedPart);
-
   _selectedPart = value;
+  _telemetryPos = 0;
 
   _partCB->setCurrentIndex(_selectedPart);
-  _emulator->set_lfo_callback(_selectedPart, this);
 
   _update_instrument_info();
 }
@@ -335,9 +328,9 @@ void LFODialog::_update_instrument_info(void)
   uint8_t rhythm =
     _emulator->get_param(EmuSC::PatchParam::UseForRhythm, _selectedPart);
   if (!rhythm) {
-    uint8_t *tone =
+    const uint8_t *tone =
       _emulator->get_param_ptr(EmuSC::PatchParam::ToneNumber, _selectedPart);
-    EmuSC::ControlRom::Instrument &iRom =
+    const EmuSC::ControlRom::Instrument &iRom =
       _emulator->get_instrument_rom(tone[0], tone[1]);
 
     _chart->setTitle(QString::fromStdString(iRom.name));
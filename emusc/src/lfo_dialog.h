@@ -27,12 +27,14 @@
 #include "emulator.h"
 #include "scene.h"
 
+#include <array>
+#include <cstdint>
+
 #include <QPushButton>
 #include <QComboBox>
 #include <QDialog>
 #include <QKeyEvent>
 #include <QLabel>
-#include <QMutex>
 #include <QString>
 #include <QTimer>
 
@@ -53,8 +55,6 @@ public:
   LFODialog(Emulator *emulator, Scene *scene, QWidget *parent = nullptr);
   virtual ~LFODialog();
 
-  void lfo_callback(const int lfo1, const int lfo2p1, const int lfo2p2);
-
 public slots:
   void chart_timeout(void);
 
@@ -66,7 +66,6 @@ private:
   Scene *_scene;
 
   QTimer _chartTimer;
-  QMutex _dataMutex;
 
   QList<QPointF> _lfo1Buf;
   QList<QPointF> _lfo2p1Buf;
@@ -109,6 +108,8 @@ private:
 
   int _timePeriod;
 
+  uint64_t _telemetryPos;       // Read position in part telemetry
+
   void keyPressEvent(QKeyEvent *keyEvent);
   void keyReleaseEvent(QKeyEvent *keyEvent);
 
@@ -118,15 +119,12 @@ private:
   void _show_legend(bool status, int lfo);
   void _set_waveform_image(int waveform, QLabel *label);
   QPixmap _invert_pixmap_color(const QPixmap &pixmap);
-
-signals:
-  void lfo_data_received(const int lfo1, const int lfo2p1, const int lfo2p2);
+  void _update_lfo_series(const int lfo1, const int lfo2p1, const int lfo2p2);
 
 private slots:
   void _partCB_changed(int value);
   void _timeCB_changed(QString string);
   void _part_changed(int partId);
-  void _update_lfo_series(const int lfo1, const int lfo2p1, const int lfo2p2);
 
 };
 
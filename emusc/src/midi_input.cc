@@ -18,11 +18,19 @@
 
 
 #include "midi_input.h"
+#include "midi_input_alsa.h"
+#include "midi_input_core.h"
+#include "midi_input_win32.h"
 
 #include <iostream>
 
 
 MidiInput::MidiInput()
+  : _numEvents(0),
+    _numSysEx(0),
+    _signalInterval(50),
+    _pendingSysEx(false),
+    _pendingLength(0)
 {}
 
 
@@ -30,6 +38,41 @@ MidiInput::~MidiInput()
 {}
 
 
+// Create MIDI input for the given MIDI system name, as stored in the
+// "Midi/system" setting
+MidiInput *MidiInput::create(QString midiSystem)
+{
+  MidiInput *midiInput = NULL;
+
+  if (!midiSystem.compare("alsa", Qt::CaseInsensitive)) {
+#ifdef __ALSA_MIDI__
+    midiInput = new MidiInputAlsa();
+#else
+    throw(QString("Alsa MIDI system is missing in this build"));
+#endif
+
+  } else if (!midiSystem.compare("core midi", Qt::CaseInsensitive)) {
+#ifdef __CORE_MIDI__
+    midiInput = new MidiInputCore();
+#else
+    throw(QString("Core MIDI system is missing in this build"));
+#endif
+
+  } else if (!midiSystem.compare("win32", Qt::CaseInsensitive)) {
+#ifdef __WIN32_MIDI__
+    midiInput = new MidiInputWin32();
+#else
+    throw(QString("Win32 MIDI system is missing in this build"));
+#endif
+  } else {
+    throw(QString("No valid MIDI system configured. This can be done in the "
+		  "Preferences dialog."));
+  }
+
+  return midiInput;
+}
+
+
 void MidiInput::start(EmuSC::Synth *synth, QString device)
 {
   _synth = synth;
@@ -48,7 +91,9 @@ void MidiInput::send_midi_event(uint8_t status, uint8_t data1, uint8_t data2)
 	      << " D2=0x" << (int) data2 << std::endl;
 
   _synth->midi_input(status, data1, data2);
-  emit new_midi_message(false, 3);
+
+  _numEvents.fetch_add(1, std::memory_order_relaxed);
+  _notify(false, 3);
 }
 
 
@@ -59,7 +104,32 @@ void MidiInput::send_midi_event_sysex(uint8_t *data, uint16_t length)
 	      << std::endl;
 
   _synth->midi_input_sysex(data, length);
-  emit new_midi_message(true, length);
+
+  _numSysEx.fetch_add(1, std::memory_order_relaxed);
+  _notify(true, length);
+}
+
+
+// Each signal is a queued cross-thread call into the GUI, so dense MIDI
+// streams are reduced to one signal per interval
+void MidiInput::_notify(bool sysEx, int length)
+{
+  int interval = _signalInterval.load(std::memory_order_relaxed);
+  if (interval < 0)
+    return;
+
+  _pendingSysEx |= sysEx;
+  _pendingLength += length;
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (now - _lastSignal < std::chrono::milliseconds(interval))
+    return;
+
+  emit new_midi_message(_pendingSysEx, _pendingLength);
+
+  _lastSignal = now;
+  _pendingSysEx = false;
+  _pendingLength = 0;
 }
 
 
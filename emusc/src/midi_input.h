@@ -24,6 +24,9 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <chrono>
+
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -41,10 +44,24 @@ protected:
 
   QString _portName;
 
+private:
+  std::atomic<uint32_t> _numEvents;
+  std::atomic<uint32_t> _numSysEx;
+
+  // Activity signals are rate limited. Only accessed from the MIDI thread.
+  std::atomic<int> _signalInterval;
+  std::chrono::steady_clock::time_point _lastSignal;
+  bool _pendingSysEx;
+  int _pendingLength;
+
+  void _notify(bool sysEx, int length);
+
 public:
   MidiInput();
   virtual ~MidiInput() = 0;
 
+  static MidiInput *create(QString midiSystem);
+
   virtual void start(EmuSC::Synth *synth, QString device);
   virtual void stop(void);
   
@@ -56,9 +73,24 @@ public:
 
   QString get_port_name(void) { return _portName; }
 
+  // Number of MIDI events and SysEx messages received. Safe to poll from any
+  // thread, e.g. on a GUI timer.
+  uint32_t get_num_events(void)
+  { return _numEvents.load(std::memory_order_relaxed); }
+  uint32_t get_num_sysex(void)
+  { return _numSysEx.load(std::memory_order_relaxed); }
+
+  // Minimum time in ms between new_midi_message signals. Messages received
+  // in between are reported in the next signal, so the last messages of a
+  // burst are not reported until more arrive. Poll the counters above if
+  // that matters. 0 => signal every message, -1 => no signals.
+  void set_signal_interval(int ms) { _signalInterval = ms; }
+
   //  virtual static QStringList get_available_devices(void);
 
 signals:
+  // Rate limited, see set_signal_interval(). Length is the total number of
+  // bytes since last signal and sysex is true if any of them were SysEx.
   void new_midi_message(bool sysex, int length);
 
 };
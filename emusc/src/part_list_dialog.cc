@@ -174,8 +174,8 @@ void PartListDialog::update_part(int partId)
   // Find instrument names
   uint8_t rhythm = _emulator->get_param(EmuSC::PatchParam::UseForRhythm,partId);
   if (!rhythm) {
-    uint8_t *tone = _emulator->get_param_ptr(EmuSC::PatchParam::ToneNumber, partId);
-    EmuSC::ControlRom::Instrument &iRom = _emulator->get_instrument_rom(tone[0], tone[1]);
+    const uint8_t *tone = _emulator->get_param_ptr(EmuSC::PatchParam::ToneNumber, partId);
+    const EmuSC::ControlRom::Instrument &iRom = _emulator->get_instrument_rom(tone[0], tone[1]);
     _instNameQTB[partId]->setText(QString(iRom.name.c_str()).leftJustified(12));
 
   } else {
@@ -291,7 +291,7 @@ QMenu *PartListDialog::_create_instrument_submenu(QString categoryName,
 
       // Instrument id 0xffff => unused, and row 126 is observed to contain junk
       if (instrumentId != 0xffff && rowNum != 126) {
-        EmuSC::ControlRom::Instrument &inst =
+        const EmuSC::ControlRom::Instrument &inst =
           _emulator->get_instrument_rom(rowNum, colNum);
 
         QAction* action = categoryMenu->addAction(inst.name.c_str());
@@ -534,6 +534,10 @@ AudioSettings::AudioSettings(Emulator *emulator, QWidget *parent)
   _reverseStereo = new QCheckBox("Reverse Stereo");
   _reverseStereo->setEnabled(false);             // TODO: Not implemented yet
   vboxLayout->addWidget(_reverseStereo);
+
+  _jackStemsCB = new QCheckBox("Separate JACK outputs for each part and "
+                               "effect return");
+  vboxLayout->addWidget(_jackStemsCB);
   vboxLayout->addStretch(0);
 
   if (_emulator->running()) {
@@ -589,6 +593,7 @@ AudioSettings::AudioSettings(Emulator *emulator, QWidget *parent)
   _sampleRateSB->setValue(sampleRate);
 //  _channelsCB->setCurrentIndex((int) stereo);
   _filePathLE->setText(settings.value("Audio/wav_file_path").toString());
+  _jackStemsCB->setChecked(settings.value("Audio/jack_stems").toBool());
 
   connect(_fileDialogTB, SIGNAL(clicked()),
 	  this, SLOT(_open_file_path_dialog()));
@@ -604,6 +609,8 @@ AudioSettings::AudioSettings(Emulator *emulator, QWidget *parent)
 	  this, SLOT(_sampleRateSB_changed(int)));
   connect(_filePathLE, SIGNAL(editingFinished()),
 	  this, SLOT(_filePathLE_changed()));
+  connect(_jackStemsCB, SIGNAL(toggled(bool)),
+	  this, SLOT(_jackStems_toggled(bool)));
 //  connect(_channelsCB, SIGNAL(currentIndexChanged(int)),
 //	  this, SLOT(_channels_box_changed(int)));
 
@@ -757,6 +764,9 @@ void AudioSettings::_system_box_changed(int index)
     _fileDialogTB->setEnabled(false);
   }
 
+  _jackStemsCB->setEnabled(!_systemBox->currentText().compare("jack",
+                                                     Qt::CaseInsensitive));
+
   QSettings settings;
   settings.setValue("Audio/system", _systemBox->currentText());
   _deviceBox->setCurrentText(settings.value("Audio/device").toString());
@@ -808,6 +818,13 @@ void AudioSettings::_filePathLE_changed(void)
 }
 
 
+void AudioSettings::_jackStems_toggled(bool checked)
+{
+  QSettings settings;
+  settings.setValue("Audio/jack_stems", checked);
+}
+
+
 void AudioSettings::_open_file_path_dialog(void)
 {
   QFileDialog dialog(this, "Select file name and location for WAV recording");
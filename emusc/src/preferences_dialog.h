@@ -140,6 +140,7 @@ private:
   QToolButton *_fileDialogTB;
 
   QCheckBox *_reverseStereo;
+  QCheckBox *_jackStemsCB;
 
   Emulator *_emulator;
 
@@ -161,6 +162,7 @@ private slots:
   void _sampleRateSB_changed(int value);
   void _filePathLE_changed(void);
   void _open_file_path_dialog(void);
+  void _jackStems_toggled(bool checked);
 
 };
 
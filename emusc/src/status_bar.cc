@@ -81,7 +81,9 @@ void SBMidiPortMsg::_new_port(QString port)
 
 
 SBMidiActLed::SBMidiActLed(Emulator *emulator, QWidget *parent)
-  : QLabel(parent)
+  : QLabel(parent),
+    _emulator(emulator),
+    _numMessages(0)
 {
   setMinimumWidth(height());
 
@@ -90,8 +92,12 @@ SBMidiActLed::SBMidiActLed(Emulator *emulator, QWidget *parent)
   _actTimer->setTimerType(Qt::CoarseTimer);
 
   connect(_actTimer, SIGNAL(timeout()), this, SLOT(_activity_timeout()));
-  connect(emulator, SIGNAL(new_midi_message(bool, int)),
-          this, SLOT(_new_activity(bool, int)));
+
+  // Poll MIDI message counter instead of receiving a signal per message
+  _pollTimer = new QTimer(this);
+  _pollTimer->setTimerType(Qt::CoarseTimer);
+  connect(_pollTimer, SIGNAL(timeout()), this, SLOT(_poll_activity()));
+  _pollTimer->start(50);
 
   _ledOff = "QLabel { border: 1px solid #001122; border-radius: 3px;"
             "background-color: qradialgradient(cx:0.5, cy:0.5, radius:0.5, fx:0.5, fy:0.5,"
@@ -150,9 +156,13 @@ void SBMidiActLed::set_state(bool state)
 }
 
 
-void SBMidiActLed::_new_activity(bool sysEx, int length)
+void SBMidiActLed::_poll_activity(void)
 {
-  Q_UNUSED(sysEx); Q_UNUSED(length);
+  uint32_t numMessages = _emulator->get_num_midi_messages();
+  if (numMessages == _numMessages)
+    return;
+
+  _numMessages = numMessages;
   set_state(true);
 }
 
@@ -79,14 +79,18 @@ public:
 
 private slots:
   void _activity_timeout(void);
-  void _new_activity(bool sysEx, int length);
+  void _poll_activity(void);
   void _update_anim_color(const QVariant &value);
 
 private:
+  Emulator *_emulator;
+
   QString _ledOff;
   QString _ledOn;
 
   QTimer *_actTimer;
+  QTimer *_pollTimer;
+  uint32_t _numMessages;
 
   QVariantAnimation *_anim;
 };
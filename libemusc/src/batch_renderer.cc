@@ -0,0 +1,266 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "batch_renderer.h"
+#include "midi_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+
+namespace EmuSC {
+
+
+BatchRenderer::BatchRenderer(const ControlRom &ctrlRom, const WaveRom &waveRom,
+                             Synth::SoundMap map)
+  : _ctrlRom(ctrlRom),
+    _waveRom(waveRom),
+    _soundMap(map),
+    _sampleRate(44100),
+    _seed(1),
+    _tail(2.0),
+    _threads(0)
+{}
+
+
+void BatchRenderer::add_job(std::string midiPath, std::string wavPath)
+{
+  _jobs.push_back({ midiPath, wavPath });
+}
+
+
+BatchRenderer::Summary
+BatchRenderer::run(std::function<void(const Result &)> callback)
+{
+  int threads = _threads;
+  if (threads <= 0)
+    threads = std::max((int) std::thread::hardware_concurrency(), 1);
+  threads = std::min(threads, std::max((int) _jobs.size(), 1));
+
+  _results.assign(_jobs.size(), Result());
+  for (size_t j = 0; j < _jobs.size(); j++) {
+    _results[j].midiPath = _jobs[j].midiPath;
+    _results[j].wavPath = _jobs[j].wavPath;
+    _results[j].length = 0;
+    _results[j].renderTime = 0;
+    _results[j].realtimeFactor = 0;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  // One synth per worker, all reset to the same power-on state for each job
+  std::vector<Synth *> synths;
+  std::vector<uint8_t> powerOn;
+  try {
+    for (int t = 0; t < threads; t++) {
+      synths.push_back(new Synth(_ctrlRom, _waveRom, _soundMap));
+      synths.back()->set_audio_format(_sampleRate, 2);
+      synths.back()->set_random_seed(_seed);
+    }
+    powerOn = synths.front()->snapshot();
+  } catch (std::string errorMsg) {
+    for (auto s : synths)
+      delete s;
+    throw(errorMsg);
+  }
+
+  // Rendered audio waiting to be written
+  struct Output {
+    size_t job;
+    std::vector<float> left;
+    std::vector<float> right;
+  };
+  std::deque<Output> pending;
+  int activeWorkers = threads;
+  std::mutex mutex;
+  std::condition_variable pendingCV;        // Signals writer
+  std::condition_variable spaceCV;          // Signals workers
+  std::atomic<size_t> nextJob(0);
+
+  auto worker = [&](Synth *synth) {
+    size_t j;
+    while ((j = nextJob.fetch_add(1)) < _jobs.size()) {
+      Output out{};
+      out.job = j;
+      try {
+        synth->restore(powerOn);
+
+        auto jobStart = std::chrono::steady_clock::now();
+        _render(*synth, _jobs[j].midiPath, out.left, out.right);
+        _results[j].renderTime = std::chrono::duration<double>
+          (std::chrono::steady_clock::now() - jobStart).count();
+        _results[j].length = (double) out.left.size() / _sampleRate;
+        if (_results[j].renderTime > 0)
+          _results[j].realtimeFactor =
+            _results[j].length / _results[j].renderTime;
+      } catch (std::string errorMsg) {
+        _results[j].error = errorMsg;
+        out.left.clear();
+        out.right.clear();
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+      spaceCV.wait(lock, [&]() {
+        return (int) pending.size() < threads * _maxPendingWrites; });
+      pending.push_back(std::move(out));
+      pendingCV.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    activeWorkers--;
+    pendingCV.notify_one();
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back(worker, synths[t]);
+
+  // Write files from this thread while the workers are rendering
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex);
+    pendingCV.wait(lock, [&]() {
+      return !pending.empty() || activeWorkers == 0; });
+    if (pending.empty())
+      break;
+
+    Output out = std::move(pending.front());
+    pending.pop_front();
+    spaceCV.notify_one();
+    lock.unlock();
+
+    Result &result = _results[out.job];
+    if (result.error.empty()) {
+      try {
+        write_wav(result.wavPath, out.left, out.right, _sampleRate);
+      } catch (std::string errorMsg) {
+        result.error = errorMsg;
+      }
+    }
+
+    if (callback)
+      callback(result);
+  }
+
+  for (auto &t : workers)
+    t.join();
+
+  for (auto s : synths)
+    delete s;
+
+  Summary summary = { (int) _jobs.size(), 0, 0, 0, 0 };
+  for (auto &r : _results) {
+    if (!r.error.empty())
+      summary.failed++;
+    else
+      summary.length += r.length;
+  }
+  summary.wallTime = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  if (summary.wallTime > 0)
+    summary.throughput = summary.length / summary.wallTime;
+
+  _jobs.clear();
+
+  return summary;
+}
+
+
+void BatchRenderer::_render(Synth &synth, const std::string &midiPath,
+                            std::vector<float> &left,
+                            std::vector<float> &right)
+{
+  MidiFile midiFile(midiPath);
+  const std::vector<MidiFile::Event> &events = midiFile.events();
+
+  int frames = static_cast<int>(std::ceil((midiFile.length() + _tail) *
+                                          _sampleRate));
+  left.assign(frames, 0.0f);
+  right.assign(frames, 0.0f);
+
+  int pos = 0;
+  size_t i = 0;
+  while (pos < frames) {
+    while (i < events.size() &&
+           std::lround(events[i].time * _sampleRate) <= pos) {
+      const MidiFile::Event &e = events[i++];
+      if (!e.sysex.empty())
+        synth.midi_input_sysex(const_cast<uint8_t *>(e.sysex.data()),
+                               e.sysex.size());
+      else
+        synth.midi_input(e.status, e.data1, e.data2);
+    }
+
+    int next = frames;
+    if (i < events.size())
+      next = std::min(next, (int) std::lround(events[i].time * _sampleRate));
+
+    synth.render_block(&left[pos], &right[pos], next - pos);
+    pos = next;
+  }
+}
+
+
+// 16 bit stereo PCM
+void BatchRenderer::write_wav(std::string path, const std::vector<float> &left,
+                              const std::vector<float> &right, int sampleRate)
+{
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open())
+    throw(std::string("Unable to create WAV file: ") + path);
+
+  auto write32 = [&](uint32_t v) { file.write((const char *) &v, 4); };
+  auto write16 = [&](uint16_t v) { file.write((const char *) &v, 2); };
+
+  uint32_t dataSize = left.size() * 4;
+  file.write("RIFF", 4);
+  write32(36 + dataSize);
+  file.write("WAVEfmt ", 8);
+  write32(16);
+  write16(1);                                      // PCM
+  write16(2);
+  write32(sampleRate);
+  write32(sampleRate * 4);
+  write16(4);
+  write16(16);
+  file.write("data", 4);
+  write32(dataSize);
+
+  std::vector<int16_t> buf;
+  buf.reserve(8192);
+  for (size_t i = 0; i < left.size(); i++) {
+    buf.push_back(std::lround(std::clamp(left[i], -1.0f, 1.0f) * 32767));
+    buf.push_back(std::lround(std::clamp(right[i], -1.0f, 1.0f) * 32767));
+    if (buf.size() == 8192 || i == left.size() - 1) {
+      file.write((const char *) buf.data(), buf.size() * 2);
+      buf.clear();
+    }
+  }
+
+  if (!file.good())
+    throw(std::string("Error while writing WAV file: ") + path);
+}
+
+}
@@ -0,0 +1,125 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Bulk rendering of many MIDI files to WAV files. The ROM files are loaded once
+// by the caller and shared read-only by a pool of worker threads, each with its
+// own Synth instance. Workers take one file at a time from a job queue and
+// hand the rendered audio over to a separate writer thread, so that rendering
+// never waits for disk I/O.
+//
+// Each worker resets its Synth to the power-on state from a snapshot before
+// every job, so the output for a file is identical to a serial render with
+// OfflineRenderer regardless of the job order and number of threads.
+
+
+#ifndef __BATCH_RENDERER_H__
+#define __BATCH_RENDERER_H__
+
+
+#include "control_rom.h"
+#include "synth.h"
+#include "wave_rom.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace EmuSC {
+
+
+class BatchRenderer
+{
+public:
+  BatchRenderer(const ControlRom &ctrlRom, const WaveRom &waveRom,
+                Synth::SoundMap map = Synth::SoundMap::GS);
+
+  void set_sample_rate(int sampleRate) { _sampleRate = sampleRate; }
+  int get_sample_rate(void) { return _sampleRate; }
+
+  // Fixed random seed for reproducible output (default 1)
+  void set_random_seed(uint64_t seed) { _seed = seed; }
+
+  // Silence rendered after the last MIDI event (default 2 seconds)
+  void set_tail(double seconds) { _tail = seconds; }
+
+  // Number of worker threads, 0 => one per CPU core (default)
+  void set_threads(int threads) { _threads = threads; }
+
+  void add_job(std::string midiPath, std::string wavPath);
+  int num_jobs(void) { return _jobs.size(); }
+
+  struct Result {
+    std::string midiPath;
+    std::string wavPath;
+    double length;                  // Rendered audio in seconds
+    double renderTime;              // Seconds spent rendering (excl. writing)
+    double realtimeFactor;          // length / renderTime
+    std::string error;              // Empty if job succeeded
+  };
+
+  struct Summary {
+    int jobs;
+    int failed;
+    double length;                  // Total rendered audio in seconds
+    double wallTime;                // Seconds from start to last file written
+    double throughput;              // length / wallTime
+  };
+
+  // Render all queued jobs and clear the queue. Blocks until all WAV files are
+  // written. Failing jobs do not stop the batch, see Result::error. The
+  // optional callback is run from the writer thread as each job completes.
+  Summary run(std::function<void(const Result &)> callback = NULL);
+
+  // Results from last run() in job order
+  const std::vector<Result> &results(void) { return _results; }
+
+  // Write 16 bit stereo PCM WAV file. Throws std::string on errors.
+  static void write_wav(std::string path, const std::vector<float> &left,
+                        const std::vector<float> &right, int sampleRate);
+
+private:
+  const ControlRom &_ctrlRom;
+  const WaveRom &_waveRom;
+  Synth::SoundMap _soundMap;
+
+  int _sampleRate;
+  uint64_t _seed;
+  double _tail;
+  int _threads;
+
+  struct Job {
+    std::string midiPath;
+    std::string wavPath;
+  };
+  std::vector<Job> _jobs;
+  std::vector<Result> _results;
+
+  // Max rendered files waiting for the writer per worker thread
+  static constexpr int _maxPendingWrites = 2;
+
+  void _render(Synth &synth, const std::string &midiPath,
+               std::vector<float> &left, std::vector<float> &right);
+
+  BatchRenderer();
+};
+
+}
+
+#endif  // __BATCH_RENDERER_H__
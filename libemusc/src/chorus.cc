@@ -92,29 +92,7 @@ void Chorus::process_sample(float input, float output[2], float *reverbSend)
     _rBuffer[(base + _sweepIndex) & rBufferMask] = v;
   };
 
-  // loop and end are offsets from the write head, so _sAaddress is an offset
-  // too, and the taps come out as delays in [0..span]
-  {
-    int loop = _loopOfs, end = _loopOfs + _span;
-    int sp = (_subPhase & 0x3fff) + _phaseInc;
-    int of = (sp >> 14) & 7;
-    _subPhase = sp & 0x3fff;
-    for (int k = 0; k < of; k++) {
-      bool atEdge = _dir ? (_sAddress == loop) : (_sAddress == end);
-      if (atEdge) _dir = !_dir;
-      else        _sAddress += _dir ? -1 : 1;
-    }
-    if (_sAddress < loop) _sAddress = loop;
-    if (_sAddress > end)  _sAddress = end;
-
-    _pTap2 = (uint16_t) (_sAddress);                // Delay of tap 2: 0..span
-    _pTap1 = (uint16_t) (loop + end - _sAddress);   // Delay of tap 1: span..0
-
-    uint16_t P = (uint16_t) (_subPhase | (_dir ? 0x8000 : 0));
-    if (P & 0x8000) _v9  = P & 0x7fff; else _v10 = P & 0x7fff;
-    uint16_t d = (uint16_t) (0x4000 - P);
-    if (d & 0x8000) _v10 = d & 0x7fff; else _v9  = d & 0x7fff;
-  }
+  _step_lfo();
 
   // Pre-LPF on (bus input + one-tick feedback).
   float bus = input + _fbSample;
@@ -139,4 +117,72 @@ void Chorus::process_sample(float input, float output[2], float *reverbSend)
   _sweepIndex = (_sweepIndex - 1) & rBufferMask;
 }
 
+
+// Advance LFO sweep and buffer position without processing any audio
+void Chorus::skip_samples(int samples)
+{
+  for (int i = 0; i < samples; i++)
+    _step_lfo();
+
+  _sweepIndex = (_sweepIndex - samples) & rBufferMask;
+}
+
+
+// loop and end are offsets from the write head, so _sAaddress is an offset
+// too, and the taps come out as delays in [0..span]
+void Chorus::_step_lfo(void)
+{
+  int loop = _loopOfs, end = _loopOfs + _span;
+  int sp = (_subPhase & 0x3fff) + _phaseInc;
+  int of = (sp >> 14) & 7;
+  _subPhase = sp & 0x3fff;
+  for (int k = 0; k < of; k++) {
+    bool atEdge = _dir ? (_sAddress == loop) : (_sAddress == end);
+    if (atEdge) _dir = !_dir;
+    else        _sAddress += _dir ? -1 : 1;
+  }
+  if (_sAddress < loop) _sAddress = loop;
+  if (_sAddress > end)  _sAddress = end;
+
+  _pTap2 = (uint16_t) (_sAddress);                // Delay of tap 2: 0..span
+  _pTap1 = (uint16_t) (loop + end - _sAddress);   // Delay of tap 1: span..0
+
+  uint16_t P = (uint16_t) (_subPhase | (_dir ? 0x8000 : 0));
+  if (P & 0x8000) _v9  = P & 0x7fff; else _v10 = P & 0x7fff;
+  uint16_t d = (uint16_t) (0x4000 - P);
+  if (d & 0x8000) _v10 = d & 0x7fff; else _v9  = d & 0x7fff;
+}
+
+
+void Chorus::serialize(StateArchive &a)
+{
+  a.io(_rBuffer);
+  a.io(_sweepIndex);
+  a.io(_pIn);
+  a.io(_pTap1);
+  a.io(_pTap2);
+  a.io(_phase);
+  a.io(_v9);
+  a.io(_v10);
+  a.io(_preA);
+  a.io(_preB);
+  a.io(_g2L);
+  a.io(_g2S);
+  a.io(_g3R);
+  a.io(_g3F);
+  a.io(_g4L);
+  a.io(_g4S);
+  a.io(_g5R);
+  a.io(_g5F);
+  a.io(_preLpfState);
+  a.io(_fbSample);
+  a.io(_phaseInc);
+  a.io(_subPhase);
+  a.io(_sAddress);
+  a.io(_dir);
+  a.io(_loopOfs);
+  a.io(_span);
+  a.io(_chorusMacroSeen);
+}
+
 }  // namespace EmuSC
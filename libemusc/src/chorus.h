@@ -49,6 +49,9 @@ class Chorus
 
   void process_sample(float input, float output[2], float *reverbSend);
   void update(void);   // call at control rate (every 256 samples)
+  void skip_samples(int samples);
+
+  void serialize(StateArchive &a);
 
  private:
   Chorus();
@@ -82,6 +85,8 @@ class Chorus
 
   int _chorusMacroSeen;
 
+  void _step_lfo(void);
+
 };
 
 }  // namespace EmuSC
@@ -32,6 +32,7 @@
 
 
 #include "control_rom.h"
+#include "log.h"
 
 #include <algorithm>
 #include <cmath>
@@ -483,6 +484,18 @@ int ControlRom::_read_samples(std::ifstream &romFile)
     s.pitchSust = _native_endian_uint16((uint8_t *) &data[14]);
     
     if (s.sampleLen) {                          // Ignore empty parts
+
+      // FIXME: A few sample definitions in the SC-55 ROM have loop length >
+      // sample length. This makes EmuSC crash as it loops outside range. The
+      // following hack prevents a crash, but audio is wrong for these samples.
+      // TODO: Figure out why this works on the real hardware.
+      // Example: Concert Cym. (Con_sym), #59 of Orchestra drumkit
+      if (s.loopLen > s.sampleLen) {
+        LOG_WARNING("Sample %d has loop length > sample length => loop "
+                    "length = sample length", (int) _samples.size());
+        s.loopLen = s.sampleLen;
+      }
+
       _samples.push_back(s);
       
       if (0)
@@ -568,7 +581,7 @@ int ControlRom::_read_lookup_tables_progrom(std::ifstream &romFile)
       numVCurves = 12;
       break;
     default:
-      std::cerr << "libEmuSC: Unsupported ROM file!" << std::endl;
+      LOG_ERROR("Unsupported ROM file!");
       exit(0);
     }
 
@@ -604,7 +617,7 @@ int ControlRom::_read_lookup_tables_cpurom(std::ifstream &romFile)
       CPUmmLUT = &SC55mkII_1_01_CPU_LUT;
       break;
     default:
-      std::cerr << "libEmuSC: Unsupported ROM file!" << std::endl;
+      LOG_ERROR("Unsupported ROM file!");
       exit(0);
     }
 
@@ -664,7 +677,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 11; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -683,7 +696,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 21; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -702,7 +715,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 47; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -721,7 +734,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 128; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -740,7 +753,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 129; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -759,7 +772,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 130; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -778,7 +791,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 136; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -797,7 +810,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 256; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -816,7 +829,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
   for (int i = 0; i < 257; i ++) {
     uint16_t value;
     if (!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))) {
-      std::cerr << "libEmuSC: Error reading LUT from ROM" << std::endl;
+      LOG_ERROR("Error reading LUT from ROM");
       return i;
     }
 
@@ -827,7 +840,7 @@ int ControlRom::_read_lut_16bit(std::ifstream &ifs, int pos,
 }
 
 
-const uint8_t ControlRom::max_polyphony(void)
+const uint8_t ControlRom::max_polyphony(void) const
 {
   switch (_synthModel)
     {
@@ -850,11 +863,11 @@ const uint8_t ControlRom::max_polyphony(void)
 int ControlRom::dump_demo_songs(std::string path)
 {
   int index = 1;
-  std::cout << "EmuSC: Searching for MIDI songs in control ROM..." << std::endl;
+  LOG_INFO("Searching for MIDI songs in control ROM...");
 
   std::ifstream romFile(_romPath, std::ios::binary | std::ios::in);
   if (!romFile.is_open()) {
-    std::cerr << "Unable to open control ROM: " << _romPath << std::endl;
+    LOG_ERROR("Unable to open control ROM: %s", _romPath.c_str());
     return -1;
   }
 
@@ -911,26 +924,24 @@ int ControlRom::dump_demo_songs(std::string path)
       std::ofstream midiFile(path + fileName, std::ios::out | std::ios::binary);
       midiFile.write((char*) &romData[i], fileSize);
       if (midiFile.good())
-	std::cout << " -> Found demo song at 0x" << std::hex << romIndex + i
-		  << " (" << std::dec << (int) fileSize << " bytes)"
-		  << std::endl
-		  << "  -> File written to " << path + fileName << std::endl;
+	LOG_INFO(" -> Found demo song at 0x%x (%d bytes), written to %s",
+		 (unsigned) (romIndex + i), (int) fileSize,
+		 (path + fileName).c_str());
       else
-	std::cout << " -> Error writing demo song to disk: " << path
-		  << " Check write permissions and available space."
-		  << std::endl;
+	LOG_ERROR(" -> Error writing demo song to disk: %s Check write "
+		  "permissions and available space.", path.c_str());
       midiFile.close();
     }
   }
 
   if (index == 1)
-    std::cout << "EmuSC: Control ROM contained no MIDI files " << std::endl;
+    LOG_INFO("Control ROM contained no MIDI files");
 
   return index - 1;
 }
 
 
-std::vector<std::vector<std::string>> ControlRom::get_instruments_list(void)
+std::vector<std::vector<std::string>> ControlRom::get_instruments_list(void) const
 {
   std::vector<std::vector<std::string>> instListVector;
 
@@ -953,7 +964,7 @@ std::vector<std::vector<std::string>> ControlRom::get_instruments_list(void)
 }
 
 
-std::vector<std::vector<std::string>> ControlRom::get_partials_list(void)
+std::vector<std::vector<std::string>> ControlRom::get_partials_list(void) const
 {
   std::vector<std::vector<std::string>> partListVector;
 
@@ -980,7 +991,7 @@ std::vector<std::vector<std::string>> ControlRom::get_partials_list(void)
 }
 
 
-std::vector<std::vector<std::string>> ControlRom::get_samples_list(void)
+std::vector<std::vector<std::string>> ControlRom::get_samples_list(void) const
 {
   std::vector<std::vector<std::string>> samplesListVector;
 
@@ -1045,7 +1056,7 @@ std::vector<uint8_t> ControlRom::get_intro_anim(int animIndex)
 
   std::ifstream romFile(_romPath, std::ios::binary | std::ios::in);
   if (!romFile.is_open()) {
-    std::cerr << "Unable to open control ROM: " << _romPath << std::endl;
+    LOG_ERROR("Unable to open control ROM: %s", _romPath.c_str());
   }
 
   std::vector<uint8_t> romData(length);
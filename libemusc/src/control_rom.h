@@ -232,29 +232,31 @@ public:
   bool intro_anim_available(void);
   std::vector<uint8_t> get_intro_anim(int animIndex = 0);
 
-  std::string model(void) { return _model; }
-  std::string version(void) { return _version; }
-  std::string date(void) { return _date; }
-  enum SynthGen generation(void) { return _synthGeneration; }
-
-  const std::array<uint8_t, 128>& get_drum_sets_LUT(void) { return _drumSetsLUT; }
-  const uint8_t max_polyphony(void);
-
-  std::vector<std::vector<std::string>> get_instruments_list(void);
-  std::vector<std::vector<std::string>> get_partials_list(void);
-  std::vector<std::vector<std::string>> get_samples_list(void);
-
-  inline struct Instrument& instrument(int i) { return _instruments[i]; }
-  inline struct Partial& partial(int p) { return _partials[p]; }
-  inline struct Sample& sample(int s) { return _samples[s]; }
-  inline struct DrumSet& drumSet(int ds) { return _drumSets[ds]; }
-  inline const std::array<std::array<uint16_t, 128>, 128>& variations() { return _variations; }
+  std::string model(void) const { return _model; }
+  std::string version(void) const { return _version; }
+  std::string date(void) const { return _date; }
+  enum SynthGen generation(void) const { return _synthGeneration; }
+
+  const std::array<uint8_t, 128>& get_drum_sets_LUT(void) const { return _drumSetsLUT; }
+  const uint8_t max_polyphony(void) const;
+
+  std::vector<std::vector<std::string>> get_instruments_list(void) const;
+  std::vector<std::vector<std::string>> get_partials_list(void) const;
+  std::vector<std::vector<std::string>> get_samples_list(void) const;
+
+  // ROM data is read-only after loading, so a ControlRom can be shared by any
+  // number of Synth instances running in separate threads
+  inline const struct Instrument& instrument(int i) const { return _instruments[i]; }
+  inline const struct Partial& partial(int p) const { return _partials[p]; }
+  inline const struct Sample& sample(int s) const { return _samples[s]; }
+  inline const struct DrumSet& drumSet(int ds) const { return _drumSets[ds]; }
+  inline const std::array<std::array<uint16_t, 128>, 128>& variations() const { return _variations; }
   inline const std::array<uint16_t, 128>& variation(int v) const { return _variations[v]; }
 
-  inline int numSampleSets(void) { return _samples.size(); }
-  inline int numInstruments(void) { return _instruments.size(); }
+  inline int numSampleSets(void) const { return _samples.size(); }
+  inline int numInstruments(void) const { return _instruments.size(); }
 
-  inline std::vector<DrumSet> &get_drumsets_ref(void) { return _drumSets; }
+  inline const std::vector<DrumSet> &get_drumsets_ref(void) const { return _drumSets; }
 
 private:
   std::string _romPath;
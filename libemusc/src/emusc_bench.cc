@@ -0,0 +1,528 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark suite for libEmuSC (emusc-bench). Built with the
+// emusc_WITH_BENCHMARKS CMake option.
+//
+// Micro benchmarks measure single DSP components on one control block (256
+// samples @ 32 kHz), macro benchmarks render a canned MIDI workload through
+// Synth. Unless real ROM files are given on the command line, a synthetic ROM
+// fixture is generated in the temp directory. Results are written as JSON
+// (default, similar to Google Benchmark) or CSV for tracking over time.
+
+
+#include "chorus.h"
+#include "control_rom.h"
+#include "params.h"
+#include "pitch.h"
+#include "resampler.h"
+#include "reverb.h"
+#include "rom_fixture.h"
+#include "settings.h"
+#include "svf.h"
+#include "synth.h"
+#include "tva.h"
+#include "wave_generator.h"
+#include "wave_oscillator.h"
+#include "wave_rom.h"
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace EmuSC;
+
+// Results are accumulated here to keep the compiler from removing work
+static volatile float sink;
+
+
+struct BenchResult {
+  std::string name;
+  uint64_t iterations;
+  double realTime;                    // ns per iteration
+  std::vector<std::pair<std::string, double>> counters;
+};
+
+
+class BenchRunner
+{
+public:
+  BenchRunner(double minTime, std::string filter)
+    : _minTime(minTime), _filter(filter) {}
+
+  // Runs fn repeatedly until minTime is reached. itemsPerIteration is used
+  // for the items_per_second counter (samples / frames / lookups)
+  void run(std::string name, double itemsPerIteration,
+           std::function<void(void)> fn,
+           std::vector<std::pair<std::string, double>> counters = {})
+  {
+    if (!_filter.empty() && name.find(_filter) == std::string::npos)
+      return;
+
+    std::cerr << "Running " << name << std::endl;
+
+    fn();                                       // Warm up
+
+    uint64_t iterations = 1;
+    double elapsed = 0;
+    while (1) {
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < iterations; i++)
+        fn();
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                              - start).count();
+
+      if (elapsed >= _minTime || iterations >= (1ull << 30))
+        break;
+
+      // Aim for 1.4 x minTime in next round, but never grow more than 10x
+      double scale = elapsed > 0 ? (_minTime * 1.4) / elapsed : 10;
+      iterations = std::max(iterations + 1,
+                            (uint64_t) (iterations * std::min(scale, 10.0)));
+    }
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.realTime = elapsed * 1e9 / iterations;
+    r.counters.push_back({ "items_per_second",
+                           itemsPerIteration * iterations / elapsed });
+    for (auto &c : counters) {
+      // Counters given as per iteration values are converted to per second
+      if (c.first == "realtime_factor")
+        r.counters.push_back({ c.first, c.second * iterations / elapsed });
+      else
+        r.counters.push_back(c);
+    }
+
+    _results.push_back(r);
+  }
+
+  std::string json(std::string romInfo)
+  {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::ostringstream ss;
+    ss << "{\n"
+       << "  \"context\": {\n"
+       << "    \"date\": \"" << date << "\",\n"
+       << "    \"library_version\": \"" << Synth::version() << "\",\n"
+       << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+       << "    \"rom\": \"" << romInfo << "\",\n"
+       << "    \"min_time\": " << _minTime << "\n"
+       << "  },\n"
+       << "  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < _results.size(); i++) {
+      BenchResult &r = _results[i];
+      ss << "    {\n"
+         << "      \"name\": \"" << r.name << "\",\n"
+         << "      \"iterations\": " << r.iterations << ",\n"
+         << "      \"real_time\": " << r.realTime << ",\n"
+         << "      \"time_unit\": \"ns\"";
+      for (auto &c : r.counters)
+        ss << ",\n      \"" << c.first << "\": " << c.second;
+      ss << "\n    }" << (i + 1 < _results.size() ? "," : "") << "\n";
+    }
+
+    ss << "  ]\n}\n";
+    return ss.str();
+  }
+
+  std::string csv(void)
+  {
+    std::ostringstream ss;
+    ss << "name,iterations,real_time,time_unit,items_per_second,"
+       << "realtime_factor,voices" << std::endl;
+
+    for (auto &r : _results) {
+      ss << r.name << "," << r.iterations << "," << r.realTime << ",ns";
+      for (std::string c : { "items_per_second", "realtime_factor", "voices" }) {
+        ss << ",";
+        for (auto &rc : r.counters)
+          if (rc.first == c)
+            ss << rc.second;
+      }
+      ss << std::endl;
+    }
+
+    return ss.str();
+  }
+
+private:
+  double _minTime;
+  std::string _filter;
+  std::vector<BenchResult> _results;
+};
+
+
+static std::array<float, 256> test_signal(void)
+{
+  std::array<float, 256> signal;
+  uint32_t noise = 1;
+  for (int i = 0; i < 256; i++) {
+    noise = noise * 1103515245 + 12345;
+    signal[i] = 0.5f * ((noise >> 16) & 0x7fff) / 32768.0f - 0.25f;
+  }
+
+  return signal;
+}
+
+
+static void bench_wave_oscillator(BenchRunner &runner, ControlRom &ctrlRom,
+                                  WaveRom &waveRom)
+{
+  const int instrument = 1;
+
+  for (int key : { 48, 72, 96 }) {
+    Settings settings(ctrlRom);
+    WaveGenerator lfo1(ctrlRom.instrument(instrument), ctrlRom.lookupTables,
+                       &settings, 0);
+    WaveGenerator lfo2(ctrlRom.instrument(instrument).partials[0],
+                       ctrlRom.lookupTables, &settings, 0);
+    Pitch pitch(ctrlRom, instrument, 0, key, 100, &lfo1, &lfo2, &settings, 0);
+
+    int sampleIndex = pitch.get_sample_id();
+    WaveOscillator osc(&ctrlRom.sample(sampleIndex),
+                       &waveRom.samples(sampleIndex).samplesF, nullptr);
+    std::array<float, 256> bus;
+
+    runner.run("WaveOscillator/key:" + std::to_string(key), 256, [&]() {
+      osc.get_sample_set(&pitch, 1.0f, bus);
+      sink = sink + bus[255];
+    });
+  }
+}
+
+
+static void bench_svf(BenchRunner &runner)
+{
+  std::array<float, 256> input = test_signal();
+  std::array<float, 256> output;
+
+  for (auto mode : { SVF::Mode::LowPass, SVF::Mode::HighPass }) {
+    SVF svf(mode);
+    svf.set_cutoff_freq(0x2000);
+    svf.set_resonance(0x40);
+
+    std::string name = (mode == SVF::Mode::LowPass) ? "lowpass" : "highpass";
+    runner.run("SVF/" + name, 256, [&]() {
+      for (int i = 0; i < 256; i++)
+        output[i] = svf.process_sample(input[i]);
+      sink = sink + output[255];
+    });
+  }
+}
+
+
+static void bench_tva(BenchRunner &runner, ControlRom &ctrlRom)
+{
+  const int instrument = 1;
+
+  Settings settings(ctrlRom);
+  WaveGenerator lfo1(ctrlRom.instrument(instrument), ctrlRom.lookupTables,
+                     &settings, 0);
+  WaveGenerator lfo2(ctrlRom.instrument(instrument).partials[0],
+                     ctrlRom.lookupTables, &settings, 0);
+  Pitch pitch(ctrlRom, instrument, 0, 60, 100, &lfo1, &lfo2, &settings, 0);
+  TVA tva(ctrlRom, 60, 100, pitch.get_sample_id(), &lfo1, &lfo2, &settings, 0,
+          instrument, 0);
+
+  std::array<float, 256> input = test_signal();
+  std::array<std::array<float, 256>, 2> bus;
+
+  // Alternate expression to force interpolated (ramped) gain every block
+  bool toggle = false;
+  runner.run("TVA/smoothing", 256, [&]() {
+    settings.set_param(PatchParam::Expression, toggle ? 0x7f : 0x40, 0);
+    toggle = !toggle;
+    bus[0] = input;
+    tva.update();
+    tva.apply_sample_set(bus);
+    sink = sink + bus[0][255] + bus[1][255];
+  });
+}
+
+
+static void bench_resampler(BenchRunner &runner)
+{
+  std::array<float, 256> input = test_signal();
+
+  for (int rate : { 22050, 44100, 48000, 96000 }) {
+    Resampler resampler;
+    resampler.set_sample_rate(rate);
+
+    runner.run("Resampler/" + std::to_string(rate), 256, [&]() {
+      float l, r;
+      for (int i = 0; i < 256; i++) {
+        resampler.push(input[i], -input[i]);
+        while (resampler.get_next_sample(l, r))
+          sink = sink + l;
+      }
+    });
+  }
+}
+
+
+static void bench_reverb(BenchRunner &runner, ControlRom &ctrlRom)
+{
+  std::array<float, 256> input = test_signal();
+
+  for (int character = 0; character < 8; character++) {
+    Settings settings(ctrlRom);
+    settings.set_param(PatchParam::ReverbCharacter, character);
+    Reverb reverb(&settings);
+    reverb.update();
+
+    runner.run("Reverb/character:" + std::to_string(character), 256, [&]() {
+      float out[2];
+      for (int i = 0; i < 256; i++) {
+        reverb.process_sample(input[i], out);
+        sink = sink + out[0];
+      }
+    });
+  }
+}
+
+
+static void bench_chorus(BenchRunner &runner, ControlRom &ctrlRom)
+{
+  std::array<float, 256> input = test_signal();
+
+  Settings settings(ctrlRom);
+  Chorus chorus(&settings);
+
+  runner.run("Chorus/block", 256, [&]() {
+    float out[2];
+    float reverbSend;
+    chorus.update();
+    for (int i = 0; i < 256; i++) {
+      chorus.process_sample(input[i], out, &reverbSend);
+      sink = sink + out[0] + reverbSend;
+    }
+  });
+}
+
+
+static void bench_settings(BenchRunner &runner, ControlRom &ctrlRom)
+{
+  Settings settings(ctrlRom);
+
+  // The same set of lookups each partial does per control block
+  runner.run("Settings/get_param", 16 * 4, [&]() {
+    int sum = 0;
+    for (int part = 0; part < 16; part++) {
+      sum += settings.get_param(PatchParam::Expression, part);
+      sum += settings.get_param(PatchParam::PartLevel, part);
+      sum += settings.get_param(PatchParam::VibratoRate, part);
+      sum += settings.get_param(SystemParam::Volume);
+    }
+    sink = sink + sum;
+  });
+
+  runner.run("Settings/get_acc_control_param", 16 * 4, [&]() {
+    int sum = 0;
+    for (int part = 0; part < 16; part++) {
+      sum += settings.get_acc_control_param(Settings::ControllerParam::Pitch, part);
+      sum += settings.get_acc_control_param(Settings::ControllerParam::TVFCutoff, part);
+      sum += settings.get_acc_control_param(Settings::ControllerParam::Amplitude, part);
+      sum += settings.get_acc_control_param(Settings::ControllerParam::LFO1PitchDepth, part);
+    }
+    sink = sink + sum;
+  });
+}
+
+
+// Canned workload: chords of the given number of voices spread over 8 parts
+// plus a drum part, re-triggered every 250 ms, with continuous modulation,
+// expression and pitch bend controller changes.
+static void render_workload(ControlRom &ctrlRom, WaveRom &waveRom, int voices,
+                            int sampleRate, double seconds)
+{
+  Synth synth(ctrlRom, waveRom);
+  synth.set_audio_format(sampleRate, 2);
+
+  for (int ch = 0; ch < 8; ch++)
+    synth.midi_input(0xc0 | ch, ch % RomFixture::numMelodicInstruments, 0);
+
+  const int frames = seconds * sampleRate;
+  const int stepFrames = sampleRate / 4;
+  std::vector<std::pair<uint8_t, uint8_t>> playing;   // channel, key
+
+  for (int f = 0; f < frames; f++) {
+    if (f % stepFrames == 0) {
+      int step = f / stepFrames;
+      for (auto &n : playing)
+        synth.midi_input(0x80 | n.first, n.second, 0x40);
+      playing.clear();
+
+      for (int n = 0; n < voices; n++) {
+        uint8_t ch = (n % 9 == 8) ? 9 : n % 8;
+        uint8_t key = (ch == 9) ? 35 + (n + step) % 12
+                                : 36 + (n * 5 + step * 7) % 60;
+        synth.midi_input(0x90 | ch, key, 64 + (n * 13) % 63);
+        playing.push_back({ ch, key });
+      }
+    }
+
+    if (f % 256 == 0) {
+      int block = f / 256;
+      uint8_t ch = block % 8;
+      synth.midi_input(0xb0 | ch, 1, (block * 3) % 128);
+      synth.midi_input(0xb0 | ch, 11, 64 + (block * 5) % 64);
+      synth.midi_input(0xe0, 0, 0x40 + (block % 16) - 8);
+    }
+
+    float l, r;
+    synth.get_next_frame(l, r);
+    sink = sink + l + r;
+  }
+}
+
+
+static void bench_synth(BenchRunner &runner, ControlRom &ctrlRom,
+                        WaveRom &waveRom)
+{
+  const int sampleRate = 44100;
+  const double seconds = 2.0;
+
+  for (int voices : { 16, 24, 64 }) {
+    runner.run("Synth/voices:" + std::to_string(voices), seconds * sampleRate,
+               [&]() {
+                 render_workload(ctrlRom, waveRom, voices, sampleRate, seconds);
+               },
+               { { "realtime_factor", seconds }, { "voices", voices } });
+  }
+}
+
+
+static void usage(void)
+{
+  std::cout << "Usage: emusc-bench [options]\n"
+            << "  --filter=STR          Only run benchmarks containing STR\n"
+            << "  --min-time=SEC        Minimum time per benchmark (0.5)\n"
+            << "  --format=json|csv     Output format (json)\n"
+            << "  --out=FILE            Write results to FILE (stdout)\n"
+            << "  --control-rom=FILE    Use real ROM files instead of the\n"
+            << "  --cpu-rom=FILE        synthetic ROM fixture. All three\n"
+            << "  --wave-rom=FILE       must be given (one wave ROM only)\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+  double minTime = 0.5;
+  std::string filter, format = "json", outFile;
+  std::string progRom, cpuRom, waveRomFile;
+
+  // Informational library messages go to stdout and would corrupt the results
+  Synth::set_log_level(Synth::LogLevel::Error);
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string value = arg.substr(arg.find('=') + 1);
+
+    if (arg.rfind("--filter=", 0) == 0) {
+      filter = value;
+    } else if (arg.rfind("--min-time=", 0) == 0) {
+      minTime = std::stod(value);
+    } else if (arg.rfind("--format=", 0) == 0) {
+      format = value;
+    } else if (arg.rfind("--out=", 0) == 0) {
+      outFile = value;
+    } else if (arg.rfind("--control-rom=", 0) == 0) {
+      progRom = value;
+    } else if (arg.rfind("--cpu-rom=", 0) == 0) {
+      cpuRom = value;
+    } else if (arg.rfind("--wave-rom=", 0) == 0) {
+      waveRomFile = value;
+    } else {
+      usage();
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+
+  if (format != "json" && format != "csv") {
+    usage();
+    return 1;
+  }
+
+  std::string romInfo = "real";
+  std::filesystem::path fixtureDir;
+  if (progRom.empty() || cpuRom.empty() || waveRomFile.empty()) {
+    romInfo = "synthetic";
+    fixtureDir = std::filesystem::temp_directory_path() /
+      ("emusc-bench-" + std::to_string(std::time(nullptr)));
+    std::filesystem::create_directories(fixtureDir);
+
+    progRom = (fixtureDir / "prog.rom").string();
+    cpuRom = (fixtureDir / "cpu.rom").string();
+    waveRomFile = (fixtureDir / "wave.rom").string();
+  }
+
+  try {
+    if (romInfo == "synthetic") {
+      RomFixture fixture;
+      fixture.write(progRom, cpuRom, waveRomFile);
+    }
+
+    ControlRom ctrlRom(progRom, cpuRom);
+    WaveRom waveRom(std::vector<std::string>{ waveRomFile }, ctrlRom);
+
+    BenchRunner runner(minTime, filter);
+    bench_wave_oscillator(runner, ctrlRom, waveRom);
+    bench_svf(runner);
+    bench_tva(runner, ctrlRom);
+    bench_resampler(runner);
+    bench_reverb(runner, ctrlRom);
+    bench_chorus(runner, ctrlRom);
+    bench_settings(runner, ctrlRom);
+    bench_synth(runner, ctrlRom, waveRom);
+
+    std::string result = (format == "csv") ? runner.csv()
+                                           : runner.json(romInfo);
+    if (outFile.empty()) {
+      std::cout << result;
+    } else {
+      std::ofstream out(outFile);
+      out << result;
+    }
+
+  } catch (std::string errorMsg) {
+    std::cerr << "emusc-bench: " << errorMsg << std::endl;
+    if (!fixtureDir.empty())
+      std::filesystem::remove_all(fixtureDir);
+    return 1;
+  }
+
+  if (!fixtureDir.empty())
+    std::filesystem::remove_all(fixtureDir);
+
+  return 0;
+}
@@ -0,0 +1,598 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Audio and performance regression tool for libEmuSC (emusc-regress). Built
+// with the emusc_WITH_REGRESSION CMake option.
+//
+// A fixed set of MIDI scenarios is rendered through Synth and compared with
+// stored golden data:
+//  - A hash of the 16 bit quantized output (exact match, reported only unless
+//    --exact is given, since floating point results differ between compilers)
+//  - RMS level per 100 ms segment and average spectrum in 1/3 octave bands,
+//    compared with a tolerance in dB
+//  - Render time per output frame, compared with a relative threshold. Only
+//    checked when the golden file contains timing (created with --update on
+//    the machine being tested)
+//
+// ROM files are read from the EMUSC_CONTROL_ROM, EMUSC_CPU_ROM and
+// EMUSC_WAVE_ROM environment variables. If not set, the synthetic ROM fixture
+// is used. Golden data is only valid for the ROM set it was created with.
+//
+// Exit code is 0 if all scenarios pass, 1 on audio drift or performance
+// regression and 2 on errors.
+
+
+#include "control_rom.h"
+#include "rom_fixture.h"
+#include "synth.h"
+#include "wave_rom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+
+using namespace EmuSC;
+
+
+struct Scenario {
+  std::string name;
+  int sampleRate;
+  double seconds;
+  std::function<void(Synth &synth, int frame, int sampleRate)> events;
+};
+
+
+struct Signature {
+  uint64_t hash;
+  std::vector<double> rms;            // dB per 100 ms segment (L+R)
+  std::vector<double> bands;          // dB per 1/3 octave band (L+R)
+  double nsPerFrame;                  // < 0 if not available
+};
+
+
+// Note on at start of step, note off at 80% of step length
+static void note_steps(Synth &synth, int frame, int stepFrames, uint8_t ch,
+                       std::vector<uint8_t> keys, uint8_t velocity)
+{
+  if (frame % stepFrames == 0)
+    for (auto k : keys)
+      synth.midi_input(0x90 | ch, k, velocity);
+  else if (frame % stepFrames == stepFrames * 4 / 5)
+    for (auto k : keys)
+      synth.midi_input(0x80 | ch, k, 0x40);
+}
+
+
+// GS DT1 SysEx message with a single data byte
+static void gs_sysex(Synth &synth, uint32_t address, uint8_t value)
+{
+  uint8_t a0 = (address >> 16) & 0x7f, a1 = (address >> 8) & 0x7f;
+  uint8_t a2 = address & 0x7f;
+  uint8_t checksum = (128 - ((a0 + a1 + a2 + value) % 128)) & 0x7f;
+  uint8_t msg[] = { 0xf0, 0x41, 0x10, 0x42, 0x12, a0, a1, a2, value, checksum,
+                    0xf7 };
+
+  synth.midi_input_sysex(msg, sizeof(msg));
+}
+
+
+static std::vector<Scenario> scenarios(void)
+{
+  std::vector<Scenario> s;
+
+  s.push_back({ "single_note", 44100, 2.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) synth.midi_input(0x90, 69, 100);
+                  if (f == sr) synth.midi_input(0x80, 69, 0x40);
+                } });
+
+  s.push_back({ "saw_chords", 44100, 2.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) synth.midi_input(0xc0, 1, 0);
+                  int step = f / (sr / 4);
+                  uint8_t root = 48 + (step % 4) * 5;
+                  note_steps(synth, f, sr / 4, 0, { root, (uint8_t) (root + 4),
+                                                    (uint8_t) (root + 7) }, 90);
+                } });
+
+  s.push_back({ "pad_modulation", 44100, 3.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) {
+                    synth.midi_input(0xc0, 3, 0);
+                    synth.midi_input(0x90, 60, 80);
+                    synth.midi_input(0x90, 67, 80);
+                  }
+                  if (f % 256 == 0)
+                    synth.midi_input(0xb0, 1, (f / 256) % 128);
+                  if (f == 2 * sr) {
+                    synth.midi_input(0x80, 60, 0x40);
+                    synth.midi_input(0x80, 67, 0x40);
+                  }
+                } });
+
+  s.push_back({ "bass_pitch_bend", 44100, 2.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) synth.midi_input(0xc0, 4, 0);
+                  note_steps(synth, f, sr / 2, 0, { 36 }, 110);
+                  if (f % 256 == 0) {
+                    int bend = 0x2000 + std::sin(f * 2 * M_PI / sr) * 0x1000;
+                    synth.midi_input(0xe0, bend & 0x7f, bend >> 7);
+                  }
+                } });
+
+  s.push_back({ "drums", 44100, 2.0,
+                [](Synth &synth, int f, int sr) {
+                  int step = f / (sr / 8);
+                  if (f % (sr / 8) == 0) {
+                    synth.midi_input(0x99, (step % 2) ? 42 : 36, 100);
+                    if (step % 4 == 2) synth.midi_input(0x99, 38, 110);
+                    if (step % 8 == 7) synth.midi_input(0x99, 46, 90);
+                  }
+                } });
+
+  s.push_back({ "effects", 44100, 3.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) {
+                    synth.midi_input(0xc0, 2, 0);
+                    synth.midi_input(0xb0, 91, 127);
+                    synth.midi_input(0xb0, 93, 127);
+                    gs_sysex(synth, 0x400130, 0x04);          // Reverb Hall 2
+                    gs_sysex(synth, 0x400138, 0x02);          // Chorus 3
+                  }
+                  if (f == sr) gs_sysex(synth, 0x400130, 0x06);   // Delay
+                  note_steps(synth, f, sr / 2, 0, { 60, 64 }, 100);
+                  if (f == 2 * sr) synth.midi_input(0xb0, 123, 0);
+                } });
+
+  s.push_back({ "polyphony_64", 44100, 2.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0)
+                    for (int ch = 0; ch < 8; ch++)
+                      synth.midi_input(0xc0 | ch, ch % 5, 0);
+                  if (f % (sr / 4) == 0) {
+                    for (int n = 0; n < 64; n++)
+                      synth.midi_input(0x90 | (n % 8), 36 + (n * 5) % 60,
+                                       64 + (n * 13) % 63);
+                  }
+                  if (f % (sr / 4) == sr / 8)
+                    for (int n = 0; n < 64; n++)
+                      synth.midi_input(0x80 | (n % 8), 36 + (n * 5) % 60, 0);
+                } });
+
+  s.push_back({ "rate_22050", 22050, 1.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) synth.midi_input(0xc0, 1, 0);
+                  note_steps(synth, f, sr / 4, 0, { 57, 69, 81 }, 100);
+                } });
+
+  s.push_back({ "rate_96000", 96000, 1.0,
+                [](Synth &synth, int f, int sr) {
+                  if (f == 0) synth.midi_input(0xc0, 1, 0);
+                  note_steps(synth, f, sr / 4, 0, { 57, 69, 81 }, 100);
+                } });
+
+  return s;
+}
+
+
+static std::vector<float> render(ControlRom &ctrlRom, WaveRom &waveRom,
+                                 const Scenario &scenario, double &nsPerFrame)
+{
+  Synth synth(ctrlRom, waveRom);
+  synth.set_audio_format(scenario.sampleRate, 2);
+
+  // Fixed seed for reproducible random pitch, panpot and LFO waveforms
+  synth.set_random_seed(1);
+
+  int frames = scenario.seconds * scenario.sampleRate;
+  std::vector<float> output(frames * 2);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) {
+    scenario.events(synth, f, scenario.sampleRate);
+    synth.get_next_frame(output[2 * f], output[2 * f + 1]);
+  }
+  nsPerFrame = std::chrono::duration<double, std::nano>
+    (std::chrono::steady_clock::now() - start).count() / frames;
+
+  return output;
+}
+
+
+static void fft(std::vector<std::complex<double>> &x)
+{
+  const size_t n = x.size();
+
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(x[i], x[j]);
+  }
+
+  for (size_t len = 2; len <= n; len <<= 1) {
+    std::complex<double> wl = std::polar(1.0, -2 * M_PI / len);
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> w(1);
+      for (size_t j = 0; j < len / 2; j++) {
+        std::complex<double> u = x[i + j], v = x[i + j + len / 2] * w;
+        x[i + j] = u + v;
+        x[i + j + len / 2] = u - v;
+        w *= wl;
+      }
+    }
+  }
+}
+
+
+static double to_dB(double power)
+{
+  return std::max(10 * std::log10(power + 1e-20), -120.0);
+}
+
+
+static Signature analyze(const std::vector<float> &pcm, int sampleRate)
+{
+  Signature sig;
+  const size_t frames = pcm.size() / 2;
+
+  // FNV-1a hash of 16 bit quantized samples
+  sig.hash = 0xcbf29ce484222325ull;
+  for (float s : pcm) {
+    int16_t q = (int16_t) std::clamp((int) std::lround(s * 32767), -32768, 32767);
+    for (int b = 0; b < 2; b++) {
+      sig.hash ^= (q >> (8 * b)) & 0xff;
+      sig.hash *= 0x100000001b3ull;
+    }
+  }
+
+  // RMS per 100 ms segment
+  const size_t segment = sampleRate / 10;
+  for (size_t start = 0; start + segment <= frames; start += segment) {
+    double sum = 0;
+    for (size_t i = start; i < start + segment; i++)
+      sum += pcm[2 * i] * pcm[2 * i] + pcm[2 * i + 1] * pcm[2 * i + 1];
+    sig.rms.push_back(to_dB(sum / segment));
+  }
+
+  // Average power spectrum in 1/3 octave bands from 50 Hz to Nyquist
+  const size_t n = 2048;
+  std::vector<double> power(n / 2, 0);
+  int blocks = 0;
+  for (size_t start = 0; start + n <= frames; start += n, blocks++) {
+    for (int ch = 0; ch < 2; ch++) {
+      std::vector<std::complex<double>> x(n);
+      for (size_t i = 0; i < n; i++) {
+        double window = 0.5 - 0.5 * std::cos(2 * M_PI * i / (n - 1));
+        x[i] = pcm[2 * (start + i) + ch] * window;
+      }
+      fft(x);
+      for (size_t k = 0; k < n / 2; k++)
+        power[k] += std::norm(x[k]) / (n * n);
+    }
+  }
+
+  for (double lo = 50; lo < sampleRate / 2.0; lo *= std::pow(2, 1 / 3.0)) {
+    double hi = std::min(lo * std::pow(2, 1 / 3.0), sampleRate / 2.0);
+    size_t kLo = std::ceil(lo * n / sampleRate);
+    size_t kHi = std::min((size_t) std::ceil(hi * n / sampleRate), n / 2);
+    double sum = 0;
+    for (size_t k = kLo; k < kHi; k++)
+      sum += power[k];
+    sig.bands.push_back(to_dB(sum / std::max(blocks, 1)));
+  }
+
+  sig.nsPerFrame = -1;
+  return sig;
+}
+
+
+static std::string hex(uint64_t value)
+{
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << value;
+  return ss.str();
+}
+
+
+// Golden file: "rom <model> <version>" followed by one block per scenario
+static std::string read_golden(std::string path,
+                               std::map<std::string, Signature> &golden)
+{
+  std::ifstream file(path);
+  if (!file.is_open())
+    throw(std::string("Unable to open golden file: ") + path);
+
+  std::string rom, line, current;
+  while (std::getline(file, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    ss >> key;
+
+    if (key.empty() || key[0] == '#') {
+      continue;
+    } else if (key == "rom") {
+      std::getline(ss >> std::ws, rom);
+    } else if (key == "scenario") {
+      ss >> current;
+      golden[current].nsPerFrame = -1;
+    } else if (key == "hash") {
+      std::string h;
+      ss >> h;
+      golden[current].hash = std::stoull(h, nullptr, 16);
+    } else if (key == "rms" || key == "bands") {
+      std::vector<double> &v = (key == "rms") ? golden[current].rms
+                                              : golden[current].bands;
+      double d;
+      while (ss >> d)
+        v.push_back(d);
+    } else if (key == "time") {
+      ss >> golden[current].nsPerFrame;
+    }
+  }
+
+  return rom;
+}
+
+
+static void write_golden(std::string path, std::string rom,
+                         std::vector<std::pair<std::string, Signature>> &sigs,
+                         bool withTime)
+{
+  std::ofstream file(path);
+  if (!file.is_open())
+    throw(std::string("Unable to create golden file: ") + path);
+
+  file << "# emusc-regress golden data, update with emusc-regress --update\n"
+       << "rom " << rom << "\n" << std::fixed << std::setprecision(2);
+
+  for (auto &s : sigs) {
+    file << "scenario " << s.first << "\n"
+         << "hash " << hex(s.second.hash) << "\n"
+         << "rms";
+    for (double d : s.second.rms)
+      file << " " << d;
+    file << "\nbands";
+    for (double d : s.second.bands)
+      file << " " << d;
+    file << "\n";
+    if (withTime)
+      file << "time " << s.second.nsPerFrame << "\n";
+  }
+}
+
+
+// Largest difference in dB, ignoring values where both are below the floor
+static double max_diff(const std::vector<double> &a,
+                       const std::vector<double> &b, double floor)
+{
+  if (a.size() != b.size())
+    return INFINITY;
+
+  double diff = 0;
+  for (size_t i = 0; i < a.size(); i++)
+    if (a[i] > floor || b[i] > floor)
+      diff = std::max(diff, std::abs(a[i] - b[i]));
+
+  return diff;
+}
+
+
+static void usage(void)
+{
+  std::cout << "Usage: emusc-regress [options]\n"
+            << "  --golden=FILE          Golden data file\n"
+            << "  --update               Write new golden data incl. timing\n"
+            << "  --update-audio         Write new golden data without timing\n"
+            << "  --filter=STR           Only run scenarios containing STR\n"
+            << "  --tolerance=DB         Allowed level / spectrum drift (0.5)\n"
+            << "  --perf-threshold=FRAC  Allowed slowdown, e.g. 0.2 = 20% (0.2)\n"
+            << "  --repeat=N             Renders per scenario, fastest is used (3)\n"
+            << "  --exact                Also fail on output hash mismatch\n"
+            << "ROM files are read from EMUSC_CONTROL_ROM, EMUSC_CPU_ROM and\n"
+            << "EMUSC_WAVE_ROM. The synthetic ROM fixture is used if not set.\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+  std::string goldenFile = EMUSC_REGRESS_GOLDEN;
+  std::string filter;
+  bool update = false, updateTime = false, exact = false;
+  double tolerance = 0.5, perfThreshold = 0.2;
+  int repeat = 3;
+
+  // Informational library messages go to stdout and would mix with the report
+  Synth::set_log_level(Synth::LogLevel::Error);
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string value = arg.substr(arg.find('=') + 1);
+
+    if (arg.rfind("--golden=", 0) == 0) {
+      goldenFile = value;
+    } else if (arg == "--update") {
+      update = updateTime = true;
+    } else if (arg == "--update-audio") {
+      update = true;
+    } else if (arg.rfind("--filter=", 0) == 0) {
+      filter = value;
+    } else if (arg.rfind("--tolerance=", 0) == 0) {
+      tolerance = std::stod(value);
+    } else if (arg.rfind("--perf-threshold=", 0) == 0) {
+      perfThreshold = std::stod(value);
+    } else if (arg.rfind("--repeat=", 0) == 0) {
+      repeat = std::max(1, std::stoi(value));
+    } else if (arg == "--exact") {
+      exact = true;
+    } else {
+      usage();
+      return (arg == "--help" || arg == "-h") ? 0 : 2;
+    }
+  }
+
+  const char *progRom = std::getenv("EMUSC_CONTROL_ROM");
+  const char *cpuRom = std::getenv("EMUSC_CPU_ROM");
+  const char *waveRomFile = std::getenv("EMUSC_WAVE_ROM");
+
+  std::filesystem::path fixtureDir;
+  std::string progPath, cpuPath, wavePath;
+  if (progRom && cpuRom && waveRomFile) {
+    progPath = progRom;
+    cpuPath = cpuRom;
+    wavePath = waveRomFile;
+  } else {
+    fixtureDir = std::filesystem::temp_directory_path() /
+      ("emusc-regress-" + std::to_string(std::time(nullptr)));
+    std::filesystem::create_directories(fixtureDir);
+    progPath = (fixtureDir / "prog.rom").string();
+    cpuPath = (fixtureDir / "cpu.rom").string();
+    wavePath = (fixtureDir / "wave.rom").string();
+  }
+
+  int failures = 0;
+  try {
+    if (!fixtureDir.empty()) {
+      RomFixture fixture;
+      fixture.write(progPath, cpuPath, wavePath);
+    }
+
+    ControlRom ctrlRom(progPath, cpuPath);
+    WaveRom waveRom(std::vector<std::string>{ wavePath }, ctrlRom);
+    std::string rom = ctrlRom.model() + " " + ctrlRom.version();
+
+    std::map<std::string, Signature> golden;
+    if (!update) {
+      std::string goldenRom = read_golden(goldenFile, golden);
+      if (goldenRom != rom)
+        throw(std::string("Golden data is for ROM '") + goldenRom +
+              "', not '" + rom + "'");
+    }
+
+    std::vector<std::pair<std::string, Signature>> results;
+    for (auto &scenario : scenarios()) {
+      if (!filter.empty() && scenario.name.find(filter) == std::string::npos)
+        continue;
+
+      double nsPerFrame, fastest = INFINITY;
+      std::vector<float> pcm;
+      uint64_t firstHash = 0;
+      bool deterministic = true;
+      for (int r = 0; r < repeat; r++) {
+        pcm = render(ctrlRom, waveRom, scenario, nsPerFrame);
+        fastest = std::min(fastest, nsPerFrame);
+
+        uint64_t h = analyze(pcm, scenario.sampleRate).hash;
+        if (r == 0)
+          firstHash = h;
+        else if (h != firstHash)
+          deterministic = false;
+      }
+
+      Signature sig = analyze(pcm, scenario.sampleRate);
+      sig.nsPerFrame = fastest;
+      results.push_back({ scenario.name, sig });
+
+      std::cout << std::left << std::setw(16) << scenario.name << std::right
+                << std::fixed << std::setprecision(1)
+                << std::setw(8) << fastest << " ns/frame  "
+                << "hash " << hex(sig.hash);
+
+      if (!deterministic) {
+        std::cout << "  FAIL: output differs between renders" << std::endl;
+        failures++;
+        continue;
+      }
+
+      if (update) {
+        std::cout << std::endl;
+        continue;
+      }
+
+      auto g = golden.find(scenario.name);
+      if (g == golden.end()) {
+        std::cout << "  FAIL: no golden data" << std::endl;
+        failures++;
+        continue;
+      }
+
+      std::vector<std::string> errors;
+      double rmsDiff = max_diff(sig.rms, g->second.rms, -90);
+      double bandDiff = max_diff(sig.bands, g->second.bands, -100);
+      if (rmsDiff > tolerance)
+        errors.push_back("level drift " + std::to_string(rmsDiff) + " dB");
+      if (bandDiff > tolerance)
+        errors.push_back("spectrum drift " + std::to_string(bandDiff) + " dB");
+      if (exact && sig.hash != g->second.hash)
+        errors.push_back("hash mismatch");
+      if (g->second.nsPerFrame > 0 &&
+          fastest > g->second.nsPerFrame * (1 + perfThreshold))
+        errors.push_back("slower than baseline " +
+                         std::to_string(g->second.nsPerFrame) + " ns/frame");
+
+      if (errors.empty()) {
+        std::cout << (sig.hash == g->second.hash ? "  PASS (exact)" : "  PASS")
+                  << std::endl;
+      } else {
+        std::cout << "  FAIL:";
+        for (auto &e : errors)
+          std::cout << " " << e << ";";
+        std::cout << std::endl;
+        failures++;
+      }
+    }
+
+    if (update) {
+      write_golden(goldenFile, rom, results, updateTime);
+      std::cout << "Golden data written to " << goldenFile << std::endl;
+    }
+
+  } catch (std::string errorMsg) {
+    std::cerr << "emusc-regress: " << errorMsg << std::endl;
+    if (!fixtureDir.empty())
+      std::filesystem::remove_all(fixtureDir);
+    return 2;
+  }
+
+  if (!fixtureDir.empty())
+    std::filesystem::remove_all(fixtureDir);
+
+  if (failures)
+    std::cout << failures << " scenario(s) failed" << std::endl;
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Command line tool for rendering MIDI files to WAV files (emusc-render).
+// Built with the emusc_WITH_RENDER CMake option.
+//
+// Long files can be split into segments that are rendered in parallel, see
+// OfflineRenderer for details. With --verify the file is also rendered
+// serially and the difference after each segment seam is checked against a
+// tolerance.
+//
+// With --batch any number of MIDI files are rendered to WAV files in parallel
+// by a pool of synths sharing the same ROM data, see BatchRenderer. Output
+// files are named after the MIDI files and written to --output-dir, or next to
+// the MIDI files if no output directory is given.
+//
+// ROM files are given as options or read from the EMUSC_CONTROL_ROM,
+// EMUSC_CPU_ROM and EMUSC_WAVE_ROM environment variables. Multiple wave ROM
+// files are separated by commas.
+//
+// Exit code is 0 on success, 1 if verification fails and 2 on errors (or if
+// any of the files in a batch failed).
+
+
+#include "batch_renderer.h"
+#include "control_rom.h"
+#include "midi_file.h"
+#include "offline_renderer.h"
+#include "wave_rom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace EmuSC;
+
+
+static void usage(void)
+{
+  std::cout << "Usage: emusc-render [options] MIDI_FILE WAV_FILE\n"
+            << "       emusc-render [options] --batch MIDI_FILE...\n"
+            << "  --control-rom=FILE     Control ROM file\n"
+            << "  --cpu-rom=FILE         CPU ROM file\n"
+            << "  --wave-rom=FILE[,..]   Wave ROM file(s)\n"
+            << "  --sample-rate=N        Output sample rate (44100)\n"
+            << "  --segments=N           Parallel segments, 0 = one per core (1)\n"
+            << "  --pre-roll=SEC         Pre-roll for each segment (3.0)\n"
+            << "  --tail=SEC             Silence after last event (2.0)\n"
+            << "  --seed=N               Random seed (1)\n"
+            << "  --verify[=DB]          Compare seams with a serial render,\n"
+            << "                         fail if difference > DB dBFS (-40)\n"
+            << "  --batch                Render all MIDI files in parallel\n"
+            << "  --threads=N            Batch threads, 0 = one per core (0)\n"
+            << "  --output-dir=DIR       Batch output directory\n"
+            << "ROM files default to EMUSC_CONTROL_ROM, EMUSC_CPU_ROM and\n"
+            << "EMUSC_WAVE_ROM.\n";
+}
+
+
+static std::vector<std::string> split(std::string list)
+{
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty())
+      items.push_back(item);
+
+  return items;
+}
+
+
+// Render all files with BatchRenderer and report each file as it is written
+static int render_batch(ControlRom &ctrlRom, WaveRom &waveRom,
+                        std::vector<std::string> midiPaths,
+                        std::string outputDir, int sampleRate, int threads,
+                        double tail, uint64_t seed)
+{
+  BatchRenderer renderer(ctrlRom, waveRom);
+  renderer.set_sample_rate(sampleRate);
+  renderer.set_random_seed(seed);
+  renderer.set_tail(tail);
+  renderer.set_threads(threads);
+
+  for (auto &midiPath : midiPaths) {
+    std::filesystem::path wavPath(midiPath);
+    wavPath.replace_extension(".wav");
+    if (!outputDir.empty())
+      wavPath = std::filesystem::path(outputDir) / wavPath.filename();
+    renderer.add_job(midiPath, wavPath.string());
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  BatchRenderer::Summary summary =
+    renderer.run([](const BatchRenderer::Result &r) {
+      if (r.error.empty())
+        std::cout << r.midiPath << " -> " << r.wavPath << ": " << r.length
+                  << " s in " << r.renderTime << " s (" << r.realtimeFactor
+                  << "x realtime)" << std::endl;
+      else
+        std::cerr << r.midiPath << ": " << r.error << std::endl;
+    });
+
+  std::cout << "Rendered " << summary.jobs - summary.failed << " of "
+            << summary.jobs << " files, " << summary.length << " s in "
+            << summary.wallTime << " s (" << summary.throughput
+            << "x realtime aggregate)" << std::endl;
+
+  return summary.failed ? 2 : 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+  std::string progPath, cpuPath, midiPath, wavPath, outputDir;
+  std::vector<std::string> wavePaths, batchPaths;
+  int sampleRate = 44100, segments = 1, threads = 0;
+  double preRoll = 3.0, tail = 2.0, tolerance = -40;
+  uint64_t seed = 1;
+  bool verify = false, batch = false;
+
+  if (std::getenv("EMUSC_CONTROL_ROM"))
+    progPath = std::getenv("EMUSC_CONTROL_ROM");
+  if (std::getenv("EMUSC_CPU_ROM"))
+    cpuPath = std::getenv("EMUSC_CPU_ROM");
+  if (std::getenv("EMUSC_WAVE_ROM"))
+    wavePaths = split(std::getenv("EMUSC_WAVE_ROM"));
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string arg(argv[i]);
+      std::string value = arg.substr(arg.find('=') + 1);
+
+      if (arg.rfind("--control-rom=", 0) == 0) {
+        progPath = value;
+      } else if (arg.rfind("--cpu-rom=", 0) == 0) {
+        cpuPath = value;
+      } else if (arg.rfind("--wave-rom=", 0) == 0) {
+        wavePaths = split(value);
+      } else if (arg.rfind("--sample-rate=", 0) == 0) {
+        sampleRate = std::stoi(value);
+      } else if (arg.rfind("--segments=", 0) == 0) {
+        segments = std::stoi(value);
+      } else if (arg.rfind("--pre-roll=", 0) == 0) {
+        preRoll = std::stod(value);
+      } else if (arg.rfind("--tail=", 0) == 0) {
+        tail = std::stod(value);
+      } else if (arg.rfind("--seed=", 0) == 0) {
+        seed = std::stoull(value);
+      } else if (arg == "--verify") {
+        verify = true;
+      } else if (arg.rfind("--verify=", 0) == 0) {
+        verify = true;
+        tolerance = std::stod(value);
+      } else if (arg == "--batch") {
+        batch = true;
+      } else if (arg.rfind("--threads=", 0) == 0) {
+        threads = std::stoi(value);
+      } else if (arg.rfind("--output-dir=", 0) == 0) {
+        outputDir = value;
+      } else if (arg[0] != '-' && batch) {
+        batchPaths.push_back(arg);
+      } else if (arg[0] != '-' && midiPath.empty()) {
+        midiPath = arg;
+      } else if (arg[0] != '-' && wavPath.empty()) {
+        wavPath = arg;
+      } else {
+        usage();
+        return (arg == "--help" || arg == "-h") ? 0 : 2;
+      }
+    }
+  } catch (std::exception &e) {
+    usage();
+    return 2;
+  }
+
+  // Positional arguments before --batch are MIDI files as well
+  if (batch) {
+    if (!midiPath.empty())
+      batchPaths.insert(batchPaths.begin(), midiPath);
+    if (!wavPath.empty())
+      batchPaths.insert(batchPaths.begin() + 1, wavPath);
+  }
+
+  if (((midiPath.empty() || wavPath.empty()) && !batch) ||
+      (batchPaths.empty() && batch) || progPath.empty() || cpuPath.empty() ||
+      wavePaths.empty() || sampleRate <= 0) {
+    usage();
+    return 2;
+  }
+
+  int result = 0;
+  try {
+    ControlRom ctrlRom(progPath, cpuPath);
+    WaveRom waveRom(wavePaths, ctrlRom);
+
+    if (batch)
+      return render_batch(ctrlRom, waveRom, batchPaths, outputDir, sampleRate,
+                          threads, tail, seed);
+
+    MidiFile midiFile(midiPath);
+
+    OfflineRenderer renderer(ctrlRom, waveRom);
+    renderer.set_sample_rate(sampleRate);
+    renderer.set_random_seed(seed);
+    renderer.set_tail(tail);
+    renderer.set_segments(segments, preRoll);
+
+    std::vector<float> left, right;
+    auto start = std::chrono::steady_clock::now();
+    int frames = renderer.render(midiFile, left, right);
+    double seconds = std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+
+    BatchRenderer::write_wav(wavPath, left, right, sampleRate);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Rendered " << (double) frames / sampleRate << " s in "
+              << renderer.seams().size() + 1 << " segment(s) in " << seconds
+              << " s (" << frames / (seconds * sampleRate) << "x realtime)"
+              << std::endl;
+
+    if (verify) {
+      std::vector<float> diff = renderer.verify(midiFile, left, right);
+      for (size_t s = 0; s < diff.size(); s++) {
+        double dB = 20 * std::log10(std::max(diff[s], 1e-10f));
+        bool pass = dB <= tolerance;
+        std::cout << "Seam at " << (double) renderer.seams()[s] / sampleRate
+                  << " s: max difference " << dB << " dBFS "
+                  << (pass ? "PASS" : "FAIL") << std::endl;
+        if (!pass)
+          result = 1;
+      }
+    }
+
+  } catch (std::string errorMsg) {
+    std::cerr << "emusc-render: " << errorMsg << std::endl;
+    return 2;
+  }
+
+  return result;
+}
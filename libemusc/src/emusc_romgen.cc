@@ -0,0 +1,112 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Command line tool for writing the synthetic ROM fixture (emusc-romgen).
+// Built with the emusc_WITH_ROMGEN CMake option. The generated control, CPU
+// and wave ROM files can be loaded by any libEmuSC application, e.g. for
+// testing and profiling on systems without the original Roland ROM files.
+
+
+#include "control_rom.h"
+#include "rom_fixture.h"
+#include "wave_rom.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace EmuSC;
+
+
+static void usage(void)
+{
+  std::cout << "Usage: emusc-romgen [options]\n"
+            << "  --out-dir=DIR         Output directory (current directory)\n"
+            << "  --control-rom=NAME    Control ROM file name (prog.rom)\n"
+            << "  --cpu-rom=NAME        CPU ROM file name (cpu.rom)\n"
+            << "  --wave-rom=NAME       Wave ROM file name (wave.rom)\n"
+            << "  --verify              Load the generated files with libEmuSC\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+  std::filesystem::path outDir = ".";
+  std::string progName = "prog.rom", cpuName = "cpu.rom";
+  std::string waveName = "wave.rom";
+  bool verify = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string value = arg.substr(arg.find('=') + 1);
+
+    if (arg.rfind("--out-dir=", 0) == 0) {
+      outDir = value;
+    } else if (arg.rfind("--control-rom=", 0) == 0) {
+      progName = value;
+    } else if (arg.rfind("--cpu-rom=", 0) == 0) {
+      cpuName = value;
+    } else if (arg.rfind("--wave-rom=", 0) == 0) {
+      waveName = value;
+    } else if (arg == "--verify") {
+      verify = true;
+    } else {
+      usage();
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+
+  std::string progPath = (outDir / progName).string();
+  std::string cpuPath = (outDir / cpuName).string();
+  std::string wavePath = (outDir / waveName).string();
+
+  try {
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    if (ec)
+      throw(std::string("Unable to create output directory: ") +
+            outDir.string());
+
+    RomFixture fixture;
+    fixture.write(progPath, cpuPath, wavePath);
+
+    std::cout << "Control ROM: " << progPath << std::endl
+              << "CPU ROM:     " << cpuPath << std::endl
+              << "Wave ROM:    " << wavePath << std::endl;
+
+    if (verify) {
+      ControlRom ctrlRom(progPath, cpuPath);
+      WaveRom waveRom(std::vector<std::string>{ wavePath }, ctrlRom);
+
+      std::cout << "Verified " << ctrlRom.model() << " " << ctrlRom.version()
+                << ": " << ctrlRom.numInstruments() << " instruments, "
+                << ctrlRom.get_partials_list().size() << " partials, "
+                << ctrlRom.numSampleSets() << " samples, "
+                << ctrlRom.get_drumsets_ref().size() << " drum sets"
+                << std::endl;
+    }
+
+  } catch (std::string errorMsg) {
+    std::cerr << "emusc-romgen: " << errorMsg << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -25,7 +25,7 @@
 namespace EmuSC {
 
 
-Envelope::Envelope(ControlRom::LookupTables &LUT)
+Envelope::Envelope(const ControlRom::LookupTables &LUT)
   : _finished(false),
     _envelopeOut(0),
     _timeKeyFlwT1T4(256),
@@ -122,4 +122,30 @@ void Envelope::set_time_velocity_sensitivity(enum Type type, bool phase,
               << " sensitivity=" << timeVelSens << std::endl;
 }
 
+
+void Envelope::_serialize_envelope(StateArchive &a)
+{
+  a.io(_phaseLevel);
+  a.io(_phaseTime);
+  a.io(_phaseValueInit);
+  a.io(_phaseDurationInit);
+  a.io(_phaseShape);
+  a.io(_phaseDuration);
+  a.io(_phaseStepSize);
+  a.io(_phasePosition);
+  a.io(_phaseRemainder);
+  a.io(_finished);
+  a.io(_phaseSampleIndex);
+  a.io(_phaseSampleNum);
+  a.io(_phaseSampleLen);
+  a.io(_phaseStartValue);
+  a.io(_phaseEndValue);
+  a.io(_envelopeOut);
+  a.io(_timeKeyFlwT1T4);
+  a.io(_timeKeyFlwT5);
+  a.io(_timeVelSensT1T2);
+  a.io(_timeVelSensT3T5);
+  a.io(_phase);
+}
+
 }
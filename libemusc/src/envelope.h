@@ -35,7 +35,7 @@ namespace EmuSC {
 class Envelope
 {
 public:
-  Envelope(ControlRom::LookupTables &LUT);
+  Envelope(const ControlRom::LookupTables &LUT);
   virtual ~Envelope() = 0;
 
   enum class Phase {
@@ -54,10 +54,13 @@ public:
   virtual void set_phase(enum Phase newPhase);
 
   inline bool finished(void) { return _finished; }
+  inline enum Phase phase(void) { return _phase; }
 
   int get_envelope_value(void) { return _envelopeOut; }
 
 protected:
+  void _serialize_envelope(StateArchive &a);
+
   virtual void _init_new_phase(enum Phase newPhase) = 0;
   virtual void _iterate_phase(void) = 0;
 
@@ -108,7 +111,7 @@ protected:
 				 "Terminated" };
 
 private:
-  ControlRom::LookupTables &_LUT;
+  const ControlRom::LookupTables &_LUT;
 
 };
 
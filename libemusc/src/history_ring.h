@@ -0,0 +1,84 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Fixed size history of values with one writer and any number of readers,
+// used for passing data from the audio thread to frontends without locks.
+// The writer never waits for readers. Each reader keeps its own position,
+// and values overwritten before being read are skipped.
+
+
+#ifndef __HISTORY_RING_H__
+#define __HISTORY_RING_H__
+
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+namespace EmuSC {
+
+
+template <typename T, int N>
+class HistoryRing
+{
+public:
+  HistoryRing() : _count(0) {}
+
+  // Writer only
+  inline void push(const T &value)
+  {
+    uint64_t n = _count.load(std::memory_order_relaxed);
+    _buf[n % N] = value;
+    _count.store(n + 1, std::memory_order_release);
+  }
+
+  // Copy up to size values written since position pos, oldest first. pos is
+  // updated to the position after the last value copied.
+  // Returns number of values copied.
+  int read(uint64_t &pos, T *data, int size)
+  {
+    uint64_t n = _count.load(std::memory_order_acquire);
+    if (pos > n || n - pos > N)
+      pos = (n > N) ? n - N : 0;
+
+    int num = (int) std::min<uint64_t>(n - pos, size);
+    for (int i = 0; i < num; i++)
+      data[i] = _buf[(pos + i) % N];
+
+    // The writer may have overwritten the oldest values while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t written = _count.load(std::memory_order_relaxed);
+    uint64_t first = (written >= N) ? written - N + 1 : 0;
+    int skip = (first > pos) ? (int) std::min<uint64_t>(first - pos, num) : 0;
+    if (skip > 0)
+      std::copy(data + skip, data + num, data);
+
+    pos += num;
+    return num - skip;
+  }
+
+private:
+  std::array<T, N> _buf;
+  std::atomic<uint64_t> _count;
+};
+
+}
+
+#endif  // __HISTORY_RING_H__
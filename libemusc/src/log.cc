@@ -0,0 +1,245 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "log.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+
+namespace EmuSC {
+
+
+std::atomic<int> Log::_level(static_cast<int>(Log::Level::Info));
+
+
+namespace {
+
+// Bounded multi-producer queue with one consumer. Each slot has a sequence
+// number telling whether it is free for the producer at that position, or
+// holds a message for the consumer. The consumer thread is started on first
+// use and sleeps until a message is pushed.
+class LogQueue
+{
+public:
+  LogQueue()
+    : _head(0),
+      _tail(0),
+      _dropped(0),
+      _quit(false),
+      _waiting(false)
+  {
+    for (uint32_t i = 0; i < _size; i++)
+      _ring[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~LogQueue()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_wakeMutex);
+      _quit = true;
+    }
+    _wakeCV.notify_one();
+
+    if (_thread.joinable())
+      _thread.join();
+  }
+
+  void push(Log::Level level, const char *format, va_list args)
+  {
+    _start();
+
+    uint32_t pos = _head.load(std::memory_order_relaxed);
+    Entry *e;
+
+    for (;;) {
+      e = &_ring[pos & (_size - 1)];
+      int32_t diff = (int32_t) (e->sequence.load(std::memory_order_acquire) -
+                                pos);
+      if (diff == 0) {
+        if (_head.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {                  // Full => drop message
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      } else {
+        pos = _head.load(std::memory_order_relaxed);
+      }
+    }
+
+    e->level = level;
+    std::vsnprintf(e->text, sizeof(e->text), format, args);
+    e->sequence.store(pos + 1, std::memory_order_release);
+
+    // Only take the mutex if the consumer is (about to start) waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiting.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(_wakeMutex);
+      _wakeCV.notify_one();
+    }
+  }
+
+  void set_callback(std::function<void(Log::Level, const std::string &)> cb)
+  {
+    _start();
+
+    std::lock_guard<std::mutex> lock(_callbackMutex);
+    _callback = cb;
+  }
+
+  uint32_t dropped(bool reset)
+  {
+    if (reset)
+      return _dropped.exchange(0, std::memory_order_relaxed);
+
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Entry {
+    std::atomic<uint32_t> sequence;
+    Log::Level level;
+    char text[248];
+  };
+
+  static constexpr uint32_t _size = 256;     // Must be a power of 2
+  std::array<Entry, _size> _ring;
+
+  std::atomic<uint32_t> _head;               // Next position for producers
+  uint32_t _tail;                            // Next position for consumer
+  std::atomic<uint32_t> _dropped;
+
+  std::thread _thread;
+  std::once_flag _started;
+  bool _quit;                                // Protected by _wakeMutex
+  std::atomic<bool> _waiting;                // Consumer is waiting on _wakeCV
+  std::mutex _wakeMutex;
+  std::condition_variable _wakeCV;
+
+  std::mutex _callbackMutex;
+  std::function<void(Log::Level, const std::string &)> _callback;
+
+  void _start(void)
+  {
+    std::call_once(_started, [this]() {
+      _thread = std::thread(&LogQueue::_run, this); });
+  }
+
+  bool _pending(void)
+  {
+    return _ring[_tail & (_size - 1)].sequence.load(std::memory_order_acquire)
+      == _tail + 1;
+  }
+
+  void _run(void)
+  {
+    std::unique_lock<std::mutex> lock(_wakeMutex);
+
+    while (!_quit) {
+      lock.unlock();
+      _drain();
+      lock.lock();
+
+      // Announce waiting before the final check, see push()
+      _waiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!_pending() && !_quit)
+        _wakeCV.wait(lock);
+      _waiting.store(false, std::memory_order_relaxed);
+    }
+
+    lock.unlock();
+    _drain();
+  }
+
+  void _drain(void)
+  {
+    while (_pending()) {
+      Entry &e = _ring[_tail & (_size - 1)];
+
+      _output(e.level, e.text);
+
+      e.sequence.store(_tail + _size, std::memory_order_release);
+      _tail++;
+    }
+  }
+
+  void _output(Log::Level level, const char *text)
+  {
+    std::lock_guard<std::mutex> lock(_callbackMutex);
+
+    if (_callback)
+      _callback(level, std::string(text));
+    else if (level == Log::Level::Error || level == Log::Level::Warning)
+      std::cerr << "libEmuSC: " << text << std::endl;
+    else
+      std::cout << "libEmuSC: " << text << std::endl;
+  }
+};
+
+// Constructed on first use to avoid depending on static initialization order
+LogQueue &log_queue(void)
+{
+  static LogQueue queue;
+  return queue;
+}
+
+}
+
+
+void Log::write(Level level, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  log_queue().push(level, format, args);
+  va_end(args);
+}
+
+
+void Log::set_level(Level level)
+{
+  _level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+
+Log::Level Log::level(void)
+{
+  return static_cast<Level>(_level.load(std::memory_order_relaxed));
+}
+
+
+void Log::set_callback(std::function<void(Level, const std::string &)> cb)
+{
+  log_queue().set_callback(cb);
+}
+
+
+uint32_t Log::get_num_dropped(bool reset)
+{
+  return log_queue().dropped(reset);
+}
+
+}
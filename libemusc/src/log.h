@@ -0,0 +1,86 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Logging for libEmuSC. Messages are formatted printf-style into a fixed size
+// lock-free ring buffer and written by a background thread, so the LOG_*
+// macros never block or allocate memory and are safe to use from the audio
+// and MIDI threads. Messages are dropped when the ring buffer is full.
+//
+// Levels above __EMUSC_MAX_LOG_LEVEL__ (emusc_MAX_LOG_LEVEL CMake option) are
+// not compiled in. The runtime level is set with Synth::set_log_level().
+
+
+#ifndef __LOG_H__
+#define __LOG_H__
+
+
+#include "synth.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+
+#ifndef __EMUSC_MAX_LOG_LEVEL__
+#define __EMUSC_MAX_LOG_LEVEL__ 4
+#endif
+
+
+namespace EmuSC {
+
+
+class Log
+{
+public:
+  typedef Synth::LogLevel Level;
+
+  static inline bool enabled(Level level)
+  { return static_cast<int>(level) <= _level.load(std::memory_order_relaxed); }
+
+  static void write(Level level, const char *format, ...);
+
+  static void set_level(Level level);
+  static Level level(void);
+
+  // Callback is run from the log thread. NULL => write to stdout / stderr
+  static void set_callback(std::function<void(Level, const std::string &)> cb);
+
+  static uint32_t get_num_dropped(bool reset);
+
+private:
+  static std::atomic<int> _level;
+
+  Log();
+};
+
+}
+
+
+#define EMUSC_LOG(level, ...) \
+  do { if (static_cast<int>(level) <= __EMUSC_MAX_LOG_LEVEL__ && \
+           EmuSC::Log::enabled(level)) \
+      EmuSC::Log::write(level, __VA_ARGS__); } while (0)
+
+#define LOG_ERROR(...)   EMUSC_LOG(EmuSC::Log::Level::Error, __VA_ARGS__)
+#define LOG_WARNING(...) EMUSC_LOG(EmuSC::Log::Level::Warning, __VA_ARGS__)
+#define LOG_INFO(...)    EMUSC_LOG(EmuSC::Log::Level::Info, __VA_ARGS__)
+#define LOG_DEBUG(...)   EMUSC_LOG(EmuSC::Log::Level::Debug, __VA_ARGS__)
+
+
+#endif  // __LOG_H__
@@ -0,0 +1,237 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "midi_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+
+namespace EmuSC {
+
+
+MidiFile::MidiFile(std::string path)
+{
+  std::ifstream file(path, std::ios::binary | std::ios::in);
+  if (!file.is_open())
+    throw(std::string("Unable to open MIDI file: ") + path);
+
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  _parse(data);
+}
+
+
+MidiFile::MidiFile(const std::vector<uint8_t> &data)
+{
+  _parse(data);
+}
+
+
+double MidiFile::length(void) const
+{
+  if (_events.empty())
+    return 0;
+
+  return _events.back().time;
+}
+
+
+static uint32_t read_be(const std::vector<uint8_t> &data, size_t pos, int size)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < size; i++)
+    value = (value << 8) | data[pos + i];
+
+  return value;
+}
+
+
+void MidiFile::_parse(const std::vector<uint8_t> &data)
+{
+  if (data.size() < 14 || std::string(data.begin(), data.begin() + 4) != "MThd")
+    throw(std::string("Not a standard MIDI file"));
+
+  uint32_t headerLen = read_be(data, 4, 4);
+  int format = read_be(data, 8, 2);
+  int numTracks = read_be(data, 10, 2);
+  uint16_t division = read_be(data, 12, 2);
+
+  if (headerLen < 6)
+    throw(std::string("Corrupt MIDI file (invalid header)"));
+  if (format > 1)
+    throw(std::string("MIDI file format ") + std::to_string(format) +
+          " is not supported");
+
+  std::vector<TrackEvent> events;
+  std::vector<TempoChange> tempo;
+
+  size_t pos = 8 + headerLen;
+  int track = 0;
+  while (track < numTracks && pos + 8 <= data.size()) {
+    std::string id(data.begin() + pos, data.begin() + pos + 4);
+    size_t end = std::min(pos + 8 + read_be(data, pos + 4, 4), data.size());
+
+    // Unknown chunks shall be ignored
+    if (id == "MTrk")
+      _read_track(data, pos + 8, end, track++, events, tempo);
+
+    pos = end;
+  }
+
+  // Merge tracks. Events at the same tick keep their track and file order.
+  std::stable_sort(events.begin(), events.end(),
+                   [](const TrackEvent &a, const TrackEvent &b)
+                   { return a.tick < b.tick; });
+  std::stable_sort(tempo.begin(), tempo.end(),
+                   [](const TempoChange &a, const TempoChange &b)
+                   { return a.tick < b.tick; });
+
+  // Convert ticks to seconds. SMPTE division has a fixed tick length.
+  double smpteTick = 0;
+  if (division & 0x8000) {
+    int fps = -static_cast<int8_t>(division >> 8);
+    double frameRate = (fps == 29) ? 29.97 : fps;
+    smpteTick = 1.0 / (frameRate * (division & 0xff));
+  } else if (division == 0) {
+    throw(std::string("Corrupt MIDI file (invalid time division)"));
+  }
+
+  uint32_t usPerQuarter = 500000;       // 120 BPM until first tempo change
+  uint32_t segmentTick = 0;
+  double segmentTime = 0;
+  size_t t = 0;
+
+  _events.reserve(events.size());
+  for (auto &e : events) {
+    if (smpteTick > 0) {
+      e.event.time = e.tick * smpteTick;
+    } else {
+      while (t < tempo.size() && tempo[t].tick <= e.tick) {
+        segmentTime += (double) (tempo[t].tick - segmentTick) * usPerQuarter /
+          (1000000.0 * division);
+        segmentTick = tempo[t].tick;
+        usPerQuarter = tempo[t].usPerQuarter;
+        t++;
+      }
+      e.event.time = segmentTime + (double) (e.tick - segmentTick) *
+        usPerQuarter / (1000000.0 * division);
+    }
+
+    _events.push_back(std::move(e.event));
+  }
+}
+
+
+void MidiFile::_read_track(const std::vector<uint8_t> &data, size_t pos,
+                           size_t end, int track,
+                           std::vector<TrackEvent> &events,
+                           std::vector<TempoChange> &tempo)
+{
+  uint32_t tick = 0;
+  uint8_t runningStatus = 0;
+
+  auto check = [&](size_t size) {
+    if (pos + size > end)
+      throw(std::string("Corrupt MIDI file (unexpected end of track)"));
+  };
+
+  while (pos < end) {
+    tick += _read_vlq(data, pos, end);
+    check(1);
+    uint8_t status = data[pos];
+
+    // Meta events
+    if (status == 0xff) {
+      check(2);
+      uint8_t type = data[pos + 1];
+      pos += 2;
+      uint32_t len = _read_vlq(data, pos, end);
+      check(len);
+
+      if (type == 0x51 && len == 3)
+        tempo.push_back({ tick, read_be(data, pos, 3) });
+      else if (type == 0x2f)                           // End of track
+        break;
+
+      pos += len;
+      continue;
+    }
+
+    // SysEx. Escaped (0xf7) packets are not sent to the synth.
+    if (status == 0xf0 || status == 0xf7) {
+      pos++;
+      runningStatus = 0;
+      uint32_t len = _read_vlq(data, pos, end);
+      check(len);
+
+      if (status == 0xf0) {
+        TrackEvent e = { tick, track, { 0, status, 0, 0, {} } };
+        e.event.sysex.reserve(len + 1);
+        e.event.sysex.push_back(0xf0);
+        e.event.sysex.insert(e.event.sysex.end(), data.begin() + pos,
+                             data.begin() + pos + len);
+        events.push_back(std::move(e));
+      }
+
+      pos += len;
+      continue;
+    }
+
+    // Channel messages, possibly using running status
+    if (status & 0x80) {
+      runningStatus = status;
+      pos++;
+    } else if (runningStatus) {
+      status = runningStatus;
+    } else {
+      throw(std::string("Corrupt MIDI file (missing status byte)"));
+    }
+
+    int type = status & 0xf0;
+    int len = (type == 0xc0 || type == 0xd0) ? 1 : 2;
+    check(len);
+
+    events.push_back({ tick, track, { 0, status, data[pos],
+                                      (uint8_t) (len == 2 ? data[pos + 1] : 0),
+                                      {} } });
+    pos += len;
+  }
+}
+
+
+uint32_t MidiFile::_read_vlq(const std::vector<uint8_t> &data, size_t &pos,
+                             size_t end)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    if (pos >= end)
+      throw(std::string("Corrupt MIDI file (unexpected end of track)"));
+
+    uint8_t byte = data[pos++];
+    value = (value << 7) | (byte & 0x7f);
+    if (!(byte & 0x80))
+      return value;
+  }
+
+  throw(std::string("Corrupt MIDI file (invalid variable length value)"));
+}
+
+}
@@ -0,0 +1,84 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standard MIDI File (SMF) reader for offline rendering. Supports format 0 and
+// 1 files with PPQN or SMPTE time division. All tracks are merged into a single
+// list of channel and SysEx events with time stamps in seconds, using the tempo
+// map found in the file. Meta events other than tempo changes are ignored.
+
+
+#ifndef __MIDI_FILE_H__
+#define __MIDI_FILE_H__
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace EmuSC {
+
+
+class MidiFile
+{
+public:
+  // Throws std::string if the file cannot be read or is not a valid SMF
+  MidiFile(std::string path);
+  MidiFile(const std::vector<uint8_t> &data);
+
+  struct Event {
+    double time;                    // Seconds from start of file
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+    std::vector<uint8_t> sysex;     // Complete message incl. 0xf0 and 0xf7
+  };
+
+  inline const std::vector<Event> &events(void) const { return _events; }
+
+  // Time of last event in seconds
+  double length(void) const;
+
+private:
+  std::vector<Event> _events;
+
+  struct TrackEvent {
+    uint32_t tick;
+    int track;
+    Event event;
+  };
+
+  struct TempoChange {
+    uint32_t tick;
+    uint32_t usPerQuarter;
+  };
+
+  void _parse(const std::vector<uint8_t> &data);
+  void _read_track(const std::vector<uint8_t> &data, size_t pos, size_t end,
+                   int track, std::vector<TrackEvent> &events,
+                   std::vector<TempoChange> &tempo);
+
+  static uint32_t _read_vlq(const std::vector<uint8_t> &data, size_t &pos,
+                            size_t end);
+
+  MidiFile();
+};
+
+}
+
+#endif  // __MIDI_FILE_H__
@@ -19,6 +19,7 @@
 
 #include "note.h"
 
+#include <algorithm>
 #include <bitset>
 #include <iostream>
 #include <cmath>
@@ -26,27 +27,30 @@
 namespace EmuSC {
 
 
-Note::Note(uint8_t key, uint8_t velocity, ControlRom &ctrlRom, WaveRom &waveRom,
-	   Settings *settings, int8_t partId)
+Note::Note(uint8_t key, uint8_t velocity, const ControlRom &ctrlRom,
+           const WaveRom &waveRom, Settings *settings, int8_t partId)
+  : Note(key, velocity,
+         _find_instrument_index(key, ctrlRom, settings, partId),
+         ctrlRom, waveRom, settings, partId)
+{}
+
+
+Note::Note(uint8_t key, uint8_t velocity, uint16_t instrumentIndex,
+           const ControlRom &ctrlRom, const WaveRom &waveRom,
+           Settings *settings, int8_t partId)
   : _key(key),
+    _velocity(velocity),
+    _instrumentIndex(instrumentIndex),
     _sustain(false),
     _stopped(false),
+    _age(0),
     _7bScale(1/127.0),
+    _LFO1(NULL),
     _settings(settings),
     _partId(partId)
 {
   _partial[0] = _partial[1] = NULL;
 
-  // 1. Find correct instrument index for note
-  // Note: toneBank is used as drumSet index for rhythm parts
-  uint8_t toneBank = settings->get_param(PatchParam::ToneNumber, partId);
-  uint8_t toneIndex = settings->get_param(PatchParam::ToneNumber2, partId);
-  uint16_t instrumentIndex;
-  if (settings->get_param(PatchParam::UseForRhythm, partId) == 0)
-    instrumentIndex = ctrlRom.variation(toneBank)[toneIndex];
-  else
-    instrumentIndex = ctrlRom.drumSet(toneBank).preset[key];
-
   if (instrumentIndex == 0xffff)        // Ignore undefined instruments / drums
     return;
 
@@ -78,6 +82,21 @@ Note::Note(uint8_t key, uint8_t velocity, ControlRom &ctrlRom, WaveRom &waveRom,
 }
 
 
+// Find correct instrument index for note
+// Note: toneBank is used as drumSet index for rhythm parts
+uint16_t Note::_find_instrument_index(uint8_t key, const ControlRom &ctrlRom,
+                                      Settings *settings, int8_t partId)
+{
+  uint8_t toneBank = settings->get_param(PatchParam::ToneNumber, partId);
+  uint8_t toneIndex = settings->get_param(PatchParam::ToneNumber2, partId);
+
+  if (settings->get_param(PatchParam::UseForRhythm, partId) == 0)
+    return ctrlRom.variation(toneBank)[toneIndex];
+
+  return ctrlRom.drumSet(toneBank).preset[key];
+}
+
+
 Note::~Note()
 {
   delete _partial[0];
@@ -128,6 +147,8 @@ void Note::sustain(bool state)
 
 void Note::update(void)
 {
+  _age++;
+
   if (_LFO1) _LFO1->update();
   if (_partial[0]) _partial[0]->update();
   if (_partial[1]) _partial[1]->update();
@@ -153,6 +174,24 @@ bool Note::get_sample_set(std::array<std::array<float, 256>, 2> &dryBus)
 }
 
 
+bool Note::skip_sample_set(void)
+{
+  bool finished[2] = {0, 0};
+
+  for (int p = 0; p < 2; p ++) {
+    if  (_partial[p] == NULL)
+      finished[p] = 1;
+    else
+      finished[p] = _partial[p]->skip_sample_set();
+  }
+
+  if (finished[0] == true && finished[1] == true)
+    return 1;
+
+  return 0;
+}
+
+
 int Note::get_num_partials()
 {
   int numPartials = 0;
@@ -165,9 +204,39 @@ int Note::get_num_partials()
 }
 
 
+// A note is released when all its partials are in the release phase or done
+bool Note::released(void)
+{
+  for (int p = 0; p < 2; p++)
+    if (_partial[p] && !_partial[p]->released())
+      return false;
+
+  return true;
+}
+
+
+// Highest TVA envelope level of the two partials, same scale as bar display
+int Note::get_tva_level(void)
+{
+  return std::max(get_current_tva(0), get_current_tva(1));
+}
+
+
+// Highest linear output gain of the two partials
+float Note::get_output_gain(void)
+{
+  float gain = 0;
+  for (int p = 0; p < 2; p++)
+    if (_partial[p])
+      gain = std::max(gain, _partial[p]->get_output_gain());
+
+  return gain;
+}
+
+
 int Note::get_current_lfo(int lfo)
 {
-  if (lfo == 0)
+  if (lfo == 0 && _LFO1)
     return _LFO1->value();
   if (lfo == 1 && _partial[0])
     return _partial[0]->get_current_lfo();
@@ -204,4 +273,26 @@ int Note::get_current_tva(bool partial)
   return _partial[partial]->get_current_tva();
 }
 
+
+void Note::serialize(StateArchive &a, const ControlRom &ctrlRom,
+                     const WaveRom &waveRom)
+{
+  a.io(_sustain);
+  a.io(_stopped);
+  a.io(_age);
+
+  // Partials that failed to initialize are not recreated
+  bool used[2] = { _partial[0] != NULL, _partial[1] != NULL };
+  a.io(used);
+  if (used[0] != (_partial[0] != NULL) || used[1] != (_partial[1] != NULL))
+    throw(std::string("Snapshot does not match control ROM partials"));
+
+  if (_LFO1)
+    _LFO1->serialize(a);
+
+  for (int p = 0; p < 2; p++)
+    if (_partial[p])
+      _partial[p]->serialize(a, ctrlRom, waveRom);
+}
+
 }
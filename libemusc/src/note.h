@@ -37,7 +37,10 @@ namespace EmuSC {
 class Note
 {
 public:
-  Note(uint8_t key, uint8_t velocity, ControlRom &ctrlRom, WaveRom &waveRom,
+  Note(uint8_t key, uint8_t velocity, const ControlRom &ctrlRom,
+       const WaveRom &waveRom, Settings *settings, int8_t partId);
+  Note(uint8_t key, uint8_t velocity, uint16_t instrumentIndex,
+       const ControlRom &ctrlRom, const WaveRom &waveRom,
        Settings *settings, int8_t partId);
   ~Note();
 
@@ -48,9 +51,24 @@ public:
   void update(void);
 
   bool get_sample_set(std::array<std::array<float, 256>, 2> &dryBus);
+  bool skip_sample_set(void);
 
   int get_num_partials(void);
 
+  // Voice allocation helpers
+  bool released(void);
+  int get_tva_level(void);
+  float get_output_gain(void);
+  uint32_t age(void) { return _age; }
+
+  // Note on parameters needed for recreating the note from a snapshot
+  uint8_t key(void) { return _key; }
+  uint8_t velocity(void) { return _velocity; }
+  uint16_t instrument_index(void) { return _instrumentIndex; }
+
+  void serialize(StateArchive &a, const ControlRom &ctrlRom,
+                 const WaveRom &waveRom);
+
   int get_current_pitch(bool partial);
   int get_current_tvf(bool partial);
   int get_current_tva(bool partial);
@@ -58,10 +76,14 @@ public:
 
 private:
   uint8_t _key;
+  uint8_t _velocity;
+  uint16_t _instrumentIndex;  // 0xffff => undefined instrument / drum
 
   bool _sustain;
   bool _stopped;
 
+  uint32_t _age;             // Number of control updates since note on
+
   const double _7bScale;     // Constant: 1 / 127
 
   WaveGenerator *_LFO1;
@@ -70,6 +92,9 @@ private:
 
   Settings *_settings;
   int8_t _partId;
+
+  static uint16_t _find_instrument_index(uint8_t key, const ControlRom &ctrlRom,
+                                         Settings *settings, int8_t partId);
 };
 
 }
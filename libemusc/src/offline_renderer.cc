@@ -0,0 +1,201 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "offline_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+
+namespace EmuSC {
+
+
+OfflineRenderer::OfflineRenderer(const ControlRom &ctrlRom,
+                                 const WaveRom &waveRom, Synth::SoundMap map)
+  : _ctrlRom(ctrlRom),
+    _waveRom(waveRom),
+    _soundMap(map),
+    _sampleRate(44100),
+    _seed(1),
+    _tail(2.0),
+    _segments(1),
+    _preRoll(3.0)
+{}
+
+
+void OfflineRenderer::set_segments(int segments, double preRoll)
+{
+  _segments = std::max(segments, 0);
+  _preRoll = std::max(preRoll, 0.0);
+}
+
+
+int OfflineRenderer::render(const MidiFile &midiFile, std::vector<float> &left,
+                            std::vector<float> &right)
+{
+  int frames = _num_frames(midiFile);
+  left.assign(frames, 0.0f);
+  right.assign(frames, 0.0f);
+
+  int segments = _segments;
+  if (segments == 0)
+    segments = std::max((int) std::thread::hardware_concurrency(), 1);
+  segments = std::clamp(segments, 1,
+                        std::max(1, (int) (frames / (_minSegmentLength *
+                                                     _sampleRate))));
+
+  // Segment boundaries, first segment starts at 0 and the last ends at frames
+  _seams.clear();
+  std::vector<int> start = { 0 };
+  for (int s = 1; s < segments; s++) {
+    int frame = _align(static_cast<int>((int64_t) frames * s / segments));
+    if (frame > start.back()) {
+      start.push_back(frame);
+      _seams.push_back(frame);
+    }
+  }
+  start.push_back(frames);
+
+  std::vector<std::thread> threads;
+  std::vector<std::string> errors(start.size() - 1);
+  for (size_t s = 0; s < start.size() - 1; s++) {
+    int chase = _align(std::max(0, start[s] - (int) (_preRoll * _sampleRate)));
+    threads.emplace_back([&, s, chase]() {
+      try {
+        _render_segment(midiFile.events(), chase, start[s], start[s + 1],
+                        &left[start[s]], &right[start[s]]);
+      } catch (std::string errorMsg) {
+        errors[s] = errorMsg;
+      }
+    });
+  }
+
+  for (auto &t : threads)
+    t.join();
+
+  for (auto &e : errors)
+    if (!e.empty())
+      throw(e);
+
+  return frames;
+}
+
+
+std::vector<float> OfflineRenderer::verify(const MidiFile &midiFile,
+                                           const std::vector<float> &left,
+                                           const std::vector<float> &right,
+                                           double window)
+{
+  int frames = _num_frames(midiFile);
+  if ((int) left.size() != frames || (int) right.size() != frames)
+    throw(std::string("Rendered audio does not match MIDI file length"));
+
+  std::vector<float> serialL(frames), serialR(frames);
+  _render_segment(midiFile.events(), 0, 0, frames, serialL.data(),
+                  serialR.data());
+
+  std::vector<float> diff;
+  for (int seam : _seams) {
+    int end = std::min(frames, seam + (int) (window * _sampleRate));
+    float maxDiff = 0;
+    for (int i = seam; i < end; i++)
+      maxDiff = std::max({ maxDiff, std::abs(left[i] - serialL[i]),
+                           std::abs(right[i] - serialR[i]) });
+    diff.push_back(maxDiff);
+  }
+
+  return diff;
+}
+
+
+int OfflineRenderer::_num_frames(const MidiFile &midiFile)
+{
+  return static_cast<int>(std::ceil((midiFile.length() + _tail) * _sampleRate));
+}
+
+
+// Round down to the closest frame that is also a control block boundary, i.e.
+// where frame * 32000 / sample rate is a multiple of 256
+int OfflineRenderer::_align(int frame)
+{
+  int64_t blockFrames = 256 * (int64_t) _sampleRate;
+  int64_t step = blockFrames / std::gcd(blockFrames, (int64_t) 32000);
+
+  return static_cast<int>(frame / step * step);
+}
+
+
+void OfflineRenderer::_render_segment(const std::vector<MidiFile::Event> &events,
+                                      int chaseFrame, int startFrame,
+                                      int endFrame, float *left, float *right)
+{
+  Synth synth(_ctrlRom, _waveRom, _soundMap);
+  synth.set_audio_format(_sampleRate, 2);
+  synth.set_random_seed(_seed);
+
+  auto frame = [&](const MidiFile::Event &e) {
+    return static_cast<int>(std::lround(e.time * _sampleRate));
+  };
+
+  // Controller chase up to the pre-roll
+  int pos = 0;
+  size_t i = 0;
+  for (; i < events.size() && frame(events[i]) < chaseFrame; i++) {
+    synth.fast_forward(frame(events[i]) - pos);
+    pos = frame(events[i]);
+    _send(synth, events[i]);
+  }
+  synth.fast_forward(chaseFrame - pos);
+  pos = chaseFrame;
+
+  // Render pre-roll (discarded) and the segment itself
+  std::vector<float> scratchL(4096), scratchR(4096);
+  while (pos < endFrame) {
+    while (i < events.size() && frame(events[i]) <= pos)
+      _send(synth, events[i++]);
+
+    int next = endFrame;
+    if (i < events.size())
+      next = std::min(next, frame(events[i]));
+
+    if (pos < startFrame) {
+      next = std::min({ next, startFrame, pos + (int) scratchL.size() });
+      synth.render_block(scratchL.data(), scratchR.data(), next - pos);
+    } else {
+      synth.render_block(left + pos - startFrame, right + pos - startFrame,
+                         next - pos);
+    }
+
+    pos = next;
+  }
+}
+
+
+void OfflineRenderer::_send(Synth &synth, const MidiFile::Event &event)
+{
+  if (!event.sysex.empty())
+    synth.midi_input_sysex(const_cast<uint8_t *>(event.sysex.data()),
+                           event.sysex.size());
+  else
+    synth.midi_input(event.status, event.data1, event.data2);
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Offline rendering of MIDI files. A song can either be rendered serially by a
+// single Synth, or split into time segments that are rendered in parallel on
+// separate threads and stitched together afterwards.
+//
+// Each segment after the first starts with a controller chase (see
+// Synth::fast_forward()) up to a point before the segment start, followed by a
+// pre-roll that is rendered and discarded. The pre-roll fills the reverb and
+// chorus buffers and the resampler history, so it must be longer than the
+// longest effect tail in the song. Segment boundaries are aligned to control
+// blocks (256 samples @ 32 kHz) so that all segments share the block timing
+// of a serial render.
+//
+// The result is not bit-identical to a serial render since filter and reverb
+// state from before the pre-roll is lost, but the difference at the seams is
+// normally far below audible level. Use verify() to measure it.
+
+
+#ifndef __OFFLINE_RENDERER_H__
+#define __OFFLINE_RENDERER_H__
+
+
+#include "control_rom.h"
+#include "midi_file.h"
+#include "synth.h"
+#include "wave_rom.h"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace EmuSC {
+
+
+class OfflineRenderer
+{
+public:
+  OfflineRenderer(const ControlRom &ctrlRom, const WaveRom &waveRom,
+                  Synth::SoundMap map = Synth::SoundMap::GS);
+
+  void set_sample_rate(int sampleRate) { _sampleRate = sampleRate; }
+  int get_sample_rate(void) { return _sampleRate; }
+
+  // Fixed random seed for reproducible output (default 1)
+  void set_random_seed(uint64_t seed) { _seed = seed; }
+
+  // Silence rendered after the last MIDI event (default 2 seconds)
+  void set_tail(double seconds) { _tail = seconds; }
+
+  // Number of parallel segments, 0 => one per CPU core, 1 => serial render.
+  // Segments are never shorter than 10 seconds. Pre-roll is in seconds.
+  void set_segments(int segments, double preRoll = 3.0);
+
+  // Render a complete MIDI file. Returns number of frames rendered. Throws
+  // std::string on errors.
+  int render(const MidiFile &midiFile, std::vector<float> &left,
+             std::vector<float> &right);
+
+  // First frame of each segment except the first from the last render()
+  const std::vector<int> &seams(void) { return _seams; }
+
+  // Render the MIDI file serially and compare with the output of a segmented
+  // render(). Returns the largest sample difference within window seconds
+  // after each seam.
+  std::vector<float> verify(const MidiFile &midiFile,
+                            const std::vector<float> &left,
+                            const std::vector<float> &right,
+                            double window = 1.0);
+
+private:
+  const ControlRom &_ctrlRom;
+  const WaveRom &_waveRom;
+  Synth::SoundMap _soundMap;
+
+  int _sampleRate;
+  uint64_t _seed;
+  double _tail;
+  int _segments;
+  double _preRoll;
+
+  std::vector<int> _seams;
+
+  static constexpr double _minSegmentLength = 10.0;   // Seconds
+
+  int _num_frames(const MidiFile &midiFile);
+  int _align(int frame);
+  void _render_segment(const std::vector<MidiFile::Event> &events,
+                       int chaseFrame, int startFrame, int endFrame,
+                       float *left, float *right);
+
+  static void _send(Synth &synth, const MidiFile::Event &event);
+
+  OfflineRenderer();
+};
+
+}
+
+#endif  // __OFFLINE_RENDERER_H__
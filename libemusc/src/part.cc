@@ -18,6 +18,8 @@
 
 
 #include "part.h"
+#include "log.h"
+#include "profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -26,18 +28,22 @@
 
 namespace EmuSC {
 
-Part::Part(uint8_t id, Settings *settings, ControlRom &ctrlRom, WaveRom &waveRom)
+Part::Part(uint8_t id, Settings *settings, const ControlRom &ctrlRom,
+           const WaveRom &waveRom)
   : _id(id),
     _settings(settings),
+    _numPartials(0),
     _lastPeakSample(0),
+    _lastRms(0),
+    _lastTvaMax(0),
+    _partBus{},
     _ctrlRom(ctrlRom),
     _waveRom(waveRom),
     _lastPitchBendRange(2)
 {
   // TODO: Rename mode => synthMode and set proper defaults for MT32 mode
   _notesMutex = new std::mutex();
-
-  _partialReserve = 2;           // TODO: Add this to settings with propoer val
+  _telemetry = new HistoryRing<Synth::PartTelemetry, 256>();
 }
 
 
@@ -45,77 +51,89 @@ Part::~Part()
 {
   delete_all_notes();
   delete _notesMutex;
+  delete _telemetry;
 }
 
 
-// All Sound Canvas modules generates 256 samples per control update.
+// All Sound Canvas modules generates 256 samples per control update. Notes are
+// rendered into the part's own bus, which is then added to the dry and effect
+// send buses shared by all parts.
 int Part::get_sample_set(std::array<std::array<float, 256>, 2> &dryBus,
 			 std::array<std::array<float, 256>, 2> &chorusBus,
 			 std::array<std::array<float, 256>, 2> &reverbBus)
 {
   _notesMutex->lock();
 
+  for (auto &b : _partBus)
+    b.fill(0.0f);
+  _lastPeakSample = 0;
+
   // Only process notes if we have any
   if (_notes.size() > 0) {
 
     // TODO: Figure out a proper way to efficiently calculate new controller
     //       values when needed. Is PitchBend the only one that needs this?
-    uint8_t pbRng = _settings->get_param(PatchParam::PB_PitchControl, _id) - 0x40;
+    uint8_t pbRng = _settings->part_cache(_id).pitchBendRange;
     if (pbRng != _lastPitchBendRange) {
       _lastPitchBendRange = pbRng;
       _settings->update_pitchBend_factor(_id);
     }
 
+    // Released notes below the audibility floor are retired without being
+    // rendered, as their remaining envelope tail cannot be heard
+    float floor = _settings->audibility_floor();
+
     // Get next sample from active notes, delete those which are finished
     std::list<Note*>::iterator itr = _notes.begin();
     while (itr != _notes.end()) {
-      bool finished = (*itr)->get_sample_set(dryBus);
+      bool finished;
+      if (floor > 0 && (*itr)->released() &&
+          (*itr)->get_output_gain() < floor)
+        finished = true;
+      else
+        finished = (*itr)->get_sample_set(_partBus);
 
-      if (finished) {
- //      std::cout << "Both partials have finished -> delete note" << std::endl;
-        delete *itr;
-        itr = _notes.erase(itr);
-      } else {
+      if (finished)
+        itr = _delete_note(itr);
+      else
         ++itr;
-      }
     }
 
-    // Store last (highest) value for future queries (typically for bar display)
-    auto itL = std::max_element(dryBus[0].begin(), dryBus[0].end());
-    _lastPeakSample = *itL;
-    auto itR = std::max_element(dryBus[0].begin(), dryBus[0].end());
-    _lastPeakSample = std::max(_lastPeakSample, *itR);
-
-    float chorusSL = _settings->get_param(PatchParam::ChorusSendLevel, _id) / 128.0f;
-    chorusBus = dryBus;
-    auto& elementC = reinterpret_cast<float(&)[2 * 256]>(chorusBus);
-    for (size_t i = 0; i < 2 * 256; ++i)
-      elementC[i] *= chorusSL;
-
-    float reverbSL = _settings->get_param(PatchParam::ReverbSendLevel, _id) / 128.0f;
-    reverbBus = dryBus;
-    auto& elementR = reinterpret_cast<float(&)[2 * 256]>(reverbBus);
-    for (size_t i = 0; i < 2 * 256; ++i)
-      elementR[i] *= reverbSL;
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::BusMix);
+
+    // Store last (highest) amplitude for future queries (typically for bar
+    // display)
+    for (int c = 0; c < 2; c++)
+      for (float s : _partBus[c])
+        _lastPeakSample = std::max(_lastPeakSample, std::fabs(s));
+
+    float chorusSL = _settings->part_cache(_id).chorusSend;
+    float reverbSL = _settings->part_cache(_id).reverbSend;
+    for (int c = 0; c < 2; c++) {
+      for (int i = 0; i < 256; i++) {
+        dryBus[c][i] += _partBus[c][i];
+        chorusBus[c][i] += _partBus[c][i] * chorusSL;
+        reverbBus[c][i] += _partBus[c][i] * reverbSL;
+      }
+    }
   }
 
-  // Export envelopes and LFOs to external client
-  if (_envelopeCallback && !_notes.empty())
-    _envelopeCallback(_notes.front()->get_current_pitch(0),
-		      _notes.front()->get_current_pitch(1),
-		      _notes.front()->get_current_tvf(0),
-		      _notes.front()->get_current_tvf(1),
-		      _notes.front()->get_current_tva(0),
-		      _notes.front()->get_current_tva(1));
-
-  if (_lfoCallback) {
-    if (!_notes.empty())
-      _lfoCallback(_notes.front()->get_current_lfo(0),
-		   _notes.front()->get_current_lfo(1),
-		   _notes.front()->get_current_lfo(2));
-    else
-      _lfoCallback(0, 0, 0);
+  // Export envelopes and LFOs to external clients
+  Synth::PartTelemetry t = {};
+  if (!_notes.empty()) {
+    Note *n = _notes.front();
+    t.active = true;
+    for (int p = 0; p < 2; p++) {
+      t.pitch[p] = n->get_current_pitch(p);
+      t.tvf[p] = n->get_current_tvf(p);
+      t.tva[p] = n->get_current_tva(p);
+    }
+    for (int l = 0; l < 3; l++)
+      t.lfo[l] = n->get_current_lfo(l);
   }
+  _telemetry->push(t);
+
+  _update_meter();
 
   _notesMutex->unlock();
 
@@ -123,24 +141,87 @@ int Part::get_sample_set(std::array<std::array<float, 256>, 2> &dryBus,
 }
 
 
+void Part::skip_sample_set(void)
+{
+  _notesMutex->lock();
+
+  for (auto &b : _partBus)
+    b.fill(0.0f);
+  _lastPeakSample = 0;
+
+  if (_notes.size() > 0) {
+    uint8_t pbRng = _settings->part_cache(_id).pitchBendRange;
+    if (pbRng != _lastPitchBendRange) {
+      _lastPitchBendRange = pbRng;
+      _settings->update_pitchBend_factor(_id);
+    }
+
+    float floor = _settings->audibility_floor();
+
+    std::list<Note*>::iterator itr = _notes.begin();
+    while (itr != _notes.end()) {
+      bool finished;
+      if (floor > 0 && (*itr)->released() &&
+          (*itr)->get_output_gain() < floor)
+        finished = true;
+      else
+        finished = (*itr)->skip_sample_set();
+
+      if (finished)
+        itr = _delete_note(itr);
+      else
+        ++itr;
+    }
+  }
+
+  _update_meter();
+
+  _notesMutex->unlock();
+}
+
+
 void Part::update(void)
 {
+  _notesMutex->lock();
+
   for (auto &n : _notes)
     n->update();
+
+  _notesMutex->unlock();
 }
 
 
-int Part::get_last_peak_sample(void)
+// Called with _notesMutex locked after each control block
+void Part::_update_meter(void)
 {
-  if (_settings->get_param(PatchParam::Mute, _id) ||
-      _settings->get_param(SystemParam::Mute))
-    return -1;
+  _lastTvaMax = 0;
+  for (auto &n: _notes)
+    _lastTvaMax = std::max({_lastTvaMax, n->get_current_tva(0),
+                            n->get_current_tva(1)});
+
+  float sum = 0;
+  if (!_notes.empty())
+    for (auto &b : _partBus)
+      for (auto s : b)
+        sum += s * s;
+  _lastRms = std::sqrt(sum / (2 * 256));
+}
+
+
+Synth::PartMeter Part::get_meter(void)
+{
+  Synth::PartMeter m = { -1, _lastPeakSample, _lastRms, _lastTvaMax };
+
+  _notesMutex->lock();
+  Settings::PartCache pc = _settings->part_cache(_id);
+  _notesMutex->unlock();
+  if (pc.mute || _settings->get_param(SystemParam::Mute))
+    return m;
 
   // Formula for peak display level: bars = (max(TVA) * PartScale) / 8;
 
   // Calculate part scale
-  int scale = _settings->get_param(PatchParam::Expression, _id) *
-              _settings->get_param(PatchParam::PartLevel, _id) *
+  int scale = pc.expression * pc.partLevel *
               _settings->get_param(SystemParam::Volume);
   scale = (((4 * scale) >> 8) & 0xffff);
   scale = ((scale * 0x8208) >> 16);
@@ -148,49 +229,166 @@ int Part::get_last_peak_sample(void)
   if (scale >= 0x8000) scale = 0x7f00;
   scale >>= 8;
 
-  int tvaMax = 0;
+  if (0)
+    std::cout << "PartScale=" << std::hex << scale
+              << " tvaMax=" << _lastTvaMax
+              << " => " << ((scale * _lastTvaMax) >> 11)
+              << std::endl;
+
+  m.level = (scale * _lastTvaMax) >> 11;
+  return m;
+}
+
+
+std::list<Note*>::iterator Part::_find_steal_candidate(bool keepNewest)
+{
+  auto end = _notes.end();
+  if (keepNewest && !_notes.empty())
+    --end;
+
+  // First choice is the quietest released note
+  auto candidate = end;
+  int minLevel = 0;
+  for (auto itr = _notes.begin(); itr != end; ++itr) {
+    if ((*itr)->get_num_partials() == 0 || !(*itr)->released())
+      continue;
+
+    int level = (*itr)->get_tva_level();
+    if (candidate == end || level < minLevel) {
+      candidate = itr;
+      minLevel = level;
+    }
+  }
+
+  if (candidate != end)
+    return candidate;
+
+  // No released notes => use the oldest note (notes are kept in note on order)
+  for (auto itr = _notes.begin(); itr != end; ++itr)
+    if ((*itr)->get_num_partials() > 0)
+      return itr;
+
+  return _notes.end();
+}
+
+
+bool Part::get_steal_candidate(StealCandidate &candidate, bool keepNewest)
+{
+  auto itr = _find_steal_candidate(keepNewest);
+  if (itr == _notes.end())
+    return false;
+
+  candidate.released = (*itr)->released();
+  candidate.level = (*itr)->get_tva_level();
+  candidate.age = (*itr)->age();
+
+  return true;
+}
+
+
+// Returns number of partials freed
+int Part::steal_note(bool keepNewest)
+{
   _notesMutex->lock();
 
-  for (auto &n: _notes)
-    tvaMax = std::max({tvaMax, n->get_current_tva(0), n->get_current_tva(1)});
+  int freed = 0;
+  auto itr = _find_steal_candidate(keepNewest);
+  if (itr != _notes.end()) {
+    freed = (*itr)->get_num_partials();
+    _delete_note(itr);
+  }
 
   _notesMutex->unlock();
 
-  if (0)
-    std::cout << "PartScale=" << std::hex << scale
-              << " tvaMax=" << tvaMax
-              << " => " << ((scale * tvaMax) >> 11)
-              << std::endl;
+  return freed;
+}
 
-  return (scale * tvaMax) >> 11;
+
+// Remove released notes with TVA envelope level below level. Returns number
+// of partials freed.
+int Part::delete_inaudible_notes(int level)
+{
+  _notesMutex->lock();
+
+  int freed = 0;
+  std::list<Note*>::iterator itr = _notes.begin();
+  while (itr != _notes.end()) {
+    if ((*itr)->released() && (*itr)->get_tva_level() < level) {
+      freed += (*itr)->get_num_partials();
+      itr = _delete_note(itr);
+    } else {
+      ++itr;
+    }
+  }
+
+  _notesMutex->unlock();
+
+  return freed;
 }
 
 
-int Part::get_num_partials(void)
+// Delete note and remove it from the key index. Notes mutex must be locked.
+std::list<Note*>::iterator Part::_delete_note(std::list<Note*>::iterator itr)
 {
-  if (_notes.size() == 0)
-    return 0;
+  std::vector<Note*> &keyNotes = _keyNotes[(*itr)->key() & 0x7f];
+  keyNotes.erase(std::find(keyNotes.begin(), keyNotes.end(), *itr));
 
-  int numPartials = 0;
-  for (auto &n: _notes)
-    numPartials += n->get_num_partials();
+  _numPartials -= (*itr)->get_num_partials();
+  delete *itr;
+
+  return _notes.erase(itr);
+}
+
+
+// Delete all notes in assign group on drum map. Notes mutex must be locked.
+int Part::_delete_assign_group_notes(uint8_t map, uint8_t group)
+{
+  int freed = 0;
+  std::list<Note*>::iterator itr = _notes.begin();
+  while (itr != _notes.end()) {
+    if (_settings->get_param(DrumParam::AssignGroupNumber, map,
+                             (*itr)->key()) == group) {
+      freed += (*itr)->get_num_partials();
+      itr = _delete_note(itr);
+    } else {
+      ++itr;
+    }
+  }
+
+  return freed;
+}
+
+
+int Part::delete_newest_note(void)
+{
+  _notesMutex->lock();
+
+  int freed = 0;
+  if (!_notes.empty()) {
+    freed = _notes.back()->get_num_partials();
+    _delete_note(std::prev(_notes.end()));
+  }
+
+  _notesMutex->unlock();
 
-  return numPartials;
+  return freed;
 }
 
 
 // Note: Mute cancels all active keys in part, and all new keys are ignored
 int Part::add_note(uint8_t key, uint8_t keyVelocity)
 {
+  _notesMutex->lock();
+  Settings::PartCache pc = _settings->part_cache(_id);
+  _notesMutex->unlock();
+
   // 1. Check if part is muted or rxNoteMessage is disabled
-  if (_settings->get_param(PatchParam::Mute, _id) ||
-      _settings->get_param(SystemParam::Mute) ||
+  if (pc.mute || _settings->get_param(SystemParam::Mute) ||
       !_settings->get_param(PatchParam::RxNoteMessage, _id))
     return 0;
 
   // 2. Check if key is outside part configured key range
-  if (key < _settings->get_param(PatchParam::KeyRangeLow, _id) ||
-      key > _settings->get_param(PatchParam::KeyRangeHigh, _id))
+  if (key < pc.keyRangeLow || key > pc.keyRangeHigh)
     return 0;
 
   // 4. If note is a drum -> check if drum accepts note on
@@ -221,8 +419,19 @@ int Part::add_note(uint8_t key, uint8_t keyVelocity)
 
   _notesMutex->lock();
 
+  // 7. Drums in the same assign group (exclusive class) as the new note, like
+  //    open and closed hi-hat, cut each other off. Group 0 => no group.
+  if (rhythm != mode_Norm) {
+    uint8_t group =
+      _settings->get_param(DrumParam::AssignGroupNumber, rhythm - 1, key);
+    if (group)
+      _delete_assign_group_notes(rhythm - 1, group);
+  }
+
   Note *n = new Note(key, velocity, _ctrlRom, _waveRom, _settings, _id);
   _notes.push_back(n);
+  _keyNotes[key & 0x7f].push_back(n);
+  _numPartials += n->get_num_partials();
 
   _notesMutex->unlock();
 
@@ -241,7 +450,7 @@ int Part::add_note(uint8_t key, uint8_t keyVelocity)
 
 int Part::stop_note(uint8_t key)
 {
-  for (auto &n : _notes)
+  for (auto &n : _keyNotes[key & 0x7f])
     n->stop(key);
 
   return 0;
@@ -267,6 +476,9 @@ int Part::delete_all_notes(void)
     delete n;
 
   _notes.clear();
+  for (auto &k : _keyNotes)
+    k.clear();
+  _numPartials = 0;
 
   _notesMutex->unlock();
 
@@ -282,192 +494,221 @@ int Part::control_change(uint8_t msgId, uint8_t value)
 
   bool updateGUI = false;
 
-  if (msgId == 0) {                                    // Bank select
-    // TODO: This check is only available for SC-55mkII+
-    if (_settings->get_param(PatchParam::RxBankSelect, _id))
-      _settings->set_param(PatchParam::ToneNumber, value, _id);
-
-  } else if (msgId == 1) {                             // Modulation
-    if (_settings->get_param(PatchParam::RxModulation, _id))
-      _settings->set_param(PatchParam::Modulation, value, _id);
-
-  } else if (msgId == 5) {                             // Portamento time
-    _settings->set_param(PatchParam::PortamentoTime, value, _id);
-
-  } else if (msgId == 6) {                             // Data entry MSB
-    // RPN
-    uint8_t msb = _settings->get_param(PatchParam::RPN_MSB, _id);
-    uint8_t lsb = _settings->get_param(PatchParam::RPN_LSB, _id);
-    if (msb != 0x7f && lsb != 0x7f)
-      if (msb == 0 && lsb == 0 && value <= 24) {         // Pitch bend range
-	_settings->set_param(PatchParam::PB_PitchControl, value + 0x40, _id);
-      } else if (msb == 0 && lsb == 1) {                 // Master fine tuning
-	_settings->set_param(PatchParam::PitchFineTune, value, _id);
-      } else if (msb == 0 && lsb == 2) {                 // Master coarse tuning
-	_settings->set_param(PatchParam::PitchCoarseTune, value, _id);
-      }
-    // NRPN
-    msb = _settings->get_param(PatchParam::NRPN_MSB, _id);
-    lsb = _settings->get_param(PatchParam::NRPN_LSB, _id);
-    if (msb != 0x7f && lsb != 0x7f)
-      if (msb == 0x01 && lsb == 0x08 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::VibratoRate, value, _id);
-      } else if (msb == 0x01 && lsb == 0x09 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::VibratoDepth, value, _id);
-      } else if (msb == 0x01 && lsb == 0x0a && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::VibratoDelay, value, _id);
-      } else if (msb == 0x01 && lsb == 0x20 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::TVFCutoffFreq, value, _id);
-      } else if (msb == 0x01 && lsb == 0x21 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::TVFResonance, value, _id);
-      } else if (msb == 0x01 && lsb == 0x63 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::TVFAEnvAttack, value, _id);
-      } else if (msb == 0x01 && lsb == 0x64 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::TVFAEnvDecay, value, _id);
-      } else if (msb == 0x01 && lsb == 0x66 && value >= 0x0e && value <= 0x72) {
-	_settings->set_param(PatchParam::TVFAEnvRelease, value, _id);
-      } else if (msb == 0x18) {
-	int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
-	if (map == 0 || map == 1)
-	  _settings->set_param(DrumParam::PlayKeyNumber, map, lsb, value);
-      } else if (msb == 0x1a) {
-	int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
-	if (map == 0 || map == 1)
-	  _settings->set_param(DrumParam::Level, map, lsb, value);
-      } else if (msb == 0x1c) {
-	int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
-	if (map == 0 || map == 1)
-	  _settings->set_param(DrumParam::Panpot, map, lsb, value);
-      } else if (msb == 0x1d) {
-	int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
-	if (map == 0 || map == 1)
-	  _settings->set_param(DrumParam::ReverbDepth, map, lsb, value);
-      }
-
-  } else if (msgId == 7) {                             // Volume
-    if (_settings->get_param(PatchParam::RxVolume, _id)) {
-      _settings->set_param(PatchParam::PartLevel, value, _id);
-      updateGUI = true;
-    }
-
-  } else if (msgId == 10) {                            // Panpot
-    if (_settings->get_param(PatchParam::RxPanpot, _id)) {
-      _settings->set_param(PatchParam::PartPanpot, value, _id);
-      updateGUI = true;
-    }
-
-  } else if (msgId == 11) {                            // Expression
-    if (_settings->get_param(PatchParam::RxExpression, _id))
-      _settings->set_param(PatchParam::Expression, value, _id);
-
-  } else if (msgId == 38) {                            // Data entry LSB
-    // Only RPN #1
-    if (_settings->get_param(PatchParam::RPN_MSB, _id) == 0 &&
-	_settings->get_param(PatchParam::RPN_LSB, _id) == 1) {
-      _settings->set_param(PatchParam::PitchFineTune2, value, _id);
+  switch (msgId)
+    {
+    case 0:                                            // Bank select
+      // TODO: This check is only available for SC-55mkII+
+      if (_settings->get_param(PatchParam::RxBankSelect, _id))
+        _settings->set_param(PatchParam::ToneNumber, value, _id);
+      break;
+
+    case 1:                                            // Modulation
+      if (_settings->get_param(PatchParam::RxModulation, _id))
+        _settings->set_param(PatchParam::Modulation, value, _id);
+      break;
+
+    case 5:                                            // Portamento time
+      _settings->set_param(PatchParam::PortamentoTime, value, _id);
+      break;
+
+    case 6: {                                          // Data entry MSB
+      // RPN
+      uint8_t msb = _settings->get_param(PatchParam::RPN_MSB, _id);
+      uint8_t lsb = _settings->get_param(PatchParam::RPN_LSB, _id);
+      if (msb != 0x7f && lsb != 0x7f)
+        if (msb == 0 && lsb == 0 && value <= 24) {         // Pitch bend range
+          _settings->set_param(PatchParam::PB_PitchControl, value + 0x40, _id);
+        } else if (msb == 0 && lsb == 1) {                 // Master fine tuning
+          _settings->set_param(PatchParam::PitchFineTune, value, _id);
+        } else if (msb == 0 && lsb == 2) {                 // Master coarse tuning
+          _settings->set_param(PatchParam::PitchCoarseTune, value, _id);
+        }
+      // NRPN
+      msb = _settings->get_param(PatchParam::NRPN_MSB, _id);
+      lsb = _settings->get_param(PatchParam::NRPN_LSB, _id);
+      if (msb != 0x7f && lsb != 0x7f)
+        if (msb == 0x01 && lsb == 0x08 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::VibratoRate, value, _id);
+        } else if (msb == 0x01 && lsb == 0x09 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::VibratoDepth, value, _id);
+        } else if (msb == 0x01 && lsb == 0x0a && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::VibratoDelay, value, _id);
+        } else if (msb == 0x01 && lsb == 0x20 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::TVFCutoffFreq, value, _id);
+        } else if (msb == 0x01 && lsb == 0x21 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::TVFResonance, value, _id);
+        } else if (msb == 0x01 && lsb == 0x63 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::TVFAEnvAttack, value, _id);
+        } else if (msb == 0x01 && lsb == 0x64 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::TVFAEnvDecay, value, _id);
+        } else if (msb == 0x01 && lsb == 0x66 && value >= 0x0e && value <= 0x72) {
+          _settings->set_param(PatchParam::TVFAEnvRelease, value, _id);
+        } else if (msb == 0x18) {
+          int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
+          if (map == 0 || map == 1)
+            _settings->set_param(DrumParam::PlayKeyNumber, map, lsb, value);
+        } else if (msb == 0x1a) {
+          int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
+          if (map == 0 || map == 1)
+            _settings->set_param(DrumParam::Level, map, lsb, value);
+        } else if (msb == 0x1c) {
+          int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
+          if (map == 0 || map == 1)
+            _settings->set_param(DrumParam::Panpot, map, lsb, value);
+        } else if (msb == 0x1d) {
+          int map = _settings->get_param(PatchParam::UseForRhythm, _id) - 1;
+          if (map == 0 || map == 1)
+            _settings->set_param(DrumParam::ReverbDepth, map, lsb, value);
+        }
+      break;
     }
 
-  } else if (msgId == 64) {                            // Hold1
-    if (_settings->get_param(PatchParam::RxHold1, _id)) {
-      if (value < 64) {
-	_settings->set_param(PatchParam::Hold1, (uint8_t) 0, _id);
-      } else {
-	_settings->set_param(PatchParam::Hold1, (uint8_t) 1, _id);
+    case 7:                                            // Volume
+      if (_settings->get_param(PatchParam::RxVolume, _id)) {
+        _settings->set_param(PatchParam::PartLevel, value, _id);
+        updateGUI = true;
       }
+      break;
 
-      for (auto &n : _notes)
-	n->sustain(_settings->get_param(PatchParam::Hold1, _id));
+    case 10:                                           // Panpot
+      if (_settings->get_param(PatchParam::RxPanpot, _id)) {
+        _settings->set_param(PatchParam::PartPanpot, value, _id);
+        updateGUI = true;
+      }
+      break;
+
+    case 11:                                           // Expression
+      if (_settings->get_param(PatchParam::RxExpression, _id))
+        _settings->set_param(PatchParam::Expression, value, _id);
+      break;
+
+    case 38:                                           // Data entry LSB
+      // Only RPN #1
+      if (_settings->get_param(PatchParam::RPN_MSB, _id) == 0 &&
+          _settings->get_param(PatchParam::RPN_LSB, _id) == 1) {
+        _settings->set_param(PatchParam::PitchFineTune2, value, _id);
+      }
+      break;
+
+    case 64:                                           // Hold1
+      if (_settings->get_param(PatchParam::RxHold1, _id)) {
+        if (value < 64) {
+          _settings->set_param(PatchParam::Hold1, (uint8_t) 0, _id);
+        } else {
+          _settings->set_param(PatchParam::Hold1, (uint8_t) 1, _id);
+        }
+
+        for (auto &n : _notes)
+          n->sustain(_settings->get_param(PatchParam::Hold1, _id));
+
+      } // Note: SC-88 Pro seems to use full 7 bit value for Hold1
+      break;
+
+    case 65:                                           // Portamento
+      if (_settings->get_param(PatchParam::RxPortamento, _id)) {
+        if (value < 64)
+          _settings->set_param(PatchParam::Portamento, (uint8_t)0,_id);
+        else
+          _settings->set_param(PatchParam::Portamento, (uint8_t)1,_id);
+      }
+      break;
 
-    } // Note: SC-88 Pro seems to use full 7 bit value for Hold1
+    case 66:                                           // Sostenuto
+      if (_settings->get_param(PatchParam::RxSostenuto, _id)) {
+        if (value < 64)
+          _settings->set_param(PatchParam::Sostenuto, (uint8_t)0,_id);
+        else
+          _settings->set_param(PatchParam::Sostenuto, (uint8_t)1,_id);
 
-  } else if (msgId == 65) {                            // Portamento
-    if (_settings->get_param(PatchParam::RxPortamento, _id)) {
-      if (value < 64)
-	_settings->set_param(PatchParam::Portamento, (uint8_t)0,_id);
-      else
-	_settings->set_param(PatchParam::Portamento, (uint8_t)1,_id);
-    }
+        for (auto &n : _notes)
+          n->sustain(_settings->get_param(PatchParam::Sostenuto, _id));
+      }
+      break;
+
+    case 67:                                           // Soft
+      if (_settings->get_param(PatchParam::RxSoft, _id)) {
+        if (value < 64)
+          _settings->set_param(PatchParam::Soft, (uint8_t)0,_id);
+        else
+          _settings->set_param(PatchParam::Soft, (uint8_t)1,_id);
+      }
+      break;
 
-  } else if (msgId == 66) {                            // Sostenuto
-    if (_settings->get_param(PatchParam::RxSostenuto, _id)) {
-      if (value < 64)
-	_settings->set_param(PatchParam::Sostenuto, (uint8_t)0,_id);
-      else
-	_settings->set_param(PatchParam::Sostenuto, (uint8_t)1,_id);
+    case 84:                                           // Portamento control
+      _settings->set_param(PatchParam::PortamentoControl, value, _id);
+      break;
 
-      for (auto &n : _notes)
-	n->sustain(_settings->get_param(PatchParam::Sostenuto, _id));
-    }
+    case 91:                                           // Reverb
+      _settings->set_param(PatchParam::ReverbSendLevel, value, _id);
+      updateGUI = true;
+      break;
 
-  } else if (msgId == 67) {                            // Soft
-    if (_settings->get_param(PatchParam::RxSoft, _id)) {
-      if (value < 64)
-	_settings->set_param(PatchParam::Soft, (uint8_t)0,_id);
-      else
-	_settings->set_param(PatchParam::Soft, (uint8_t)1,_id);
+    case 93:                                           // Chorus
+      _settings->set_param(PatchParam::ChorusSendLevel, value, _id);
+      updateGUI = true;
+      break;
+
+    case 98:                                           // NRPN LSB
+      if (_settings->get_param(PatchParam::RxNRPN, _id))
+        _settings->set_param(PatchParam::NRPN_LSB, value, _id);
+      break;
+
+    case 99:                                           // NRPN MSB
+      if (_settings->get_param(PatchParam::RxNRPN, _id))
+        _settings->set_param(PatchParam::NRPN_MSB, value, _id);
+      break;
+
+    case 100:                                          // RPN LSB
+      if (_settings->get_param(PatchParam::RxRPN, _id))
+        _settings->set_param(PatchParam::RPN_LSB, value, _id);
+      break;
+
+    case 101:                                          // RPN MSB
+      if (_settings->get_param(PatchParam::RxRPN, _id))
+        _settings->set_param(PatchParam::RPN_MSB, value, _id);
+      break;
+
+    // Channel Mode messages
+    case 120:                                          // All Sounds Off
+      delete_all_notes();
+      break;
+
+    case 121:                                          // Reset All Controllers
+      pitch_bend_change(0x00, 0x40, true);
+      _settings->set_param(PatchParam::PolyKeyPressure, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::ChannelPressure, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::Modulation, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::Expression, 127, (int8_t) _id);
+      _settings->set_param(PatchParam::Hold1, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::Portamento, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::Sostenuto, 0, (int8_t) _id);
+      _settings->set_param(PatchParam::Soft, 0, (int8_t) _id);
+      // RPN & NRPN LSB/MSB -> 0x7f?
+      break;
+
+    case 123:                                          // All Notes Off
+      stop_all_notes();
+      break;
+
+    case 124:                                          // OMNI Off
+      stop_all_notes();
+      break;
+
+    case 125:                                          // OMNI On
+      stop_all_notes();
+      break;
+
+    case 126:                                          // Mono (-> Mode 4)
+      stop_all_notes();
+      _settings->set_param(PatchParam::PolyMode, (uint8_t) 0, (int8_t) _id);
+      break;
+
+    case 127:                                          // Poly (-> Mode 3)
+      stop_all_notes();
+      _settings->set_param(PatchParam::PolyMode, (uint8_t) 1, (int8_t) _id);
+      break;
     }
 
-  } else if (msgId == 84) {                            // Portamento control
-    _settings->set_param(PatchParam::PortamentoControl, value, _id);
-
-  } else if (msgId == 91) {                            // Reverb
-    _settings->set_param(PatchParam::ReverbSendLevel, value, _id);
-    updateGUI = true;
-
-  } else if (msgId == 93) {                            // Chorus
-    _settings->set_param(PatchParam::ChorusSendLevel, value, _id);
-    updateGUI = true;
-
-  } else if (msgId == 98) {                            // NRPN LSB
-    if (_settings->get_param(PatchParam::RxNRPN, _id))
-      _settings->set_param(PatchParam::NRPN_LSB, value, _id);
-
-  } else if (msgId == 99) {                            // NRPN MSB
-    if (_settings->get_param(PatchParam::RxNRPN, _id))
-      _settings->set_param(PatchParam::NRPN_MSB, value, _id);
-
-  } else if (msgId == 100) {                           // RPN LSB
-    if (_settings->get_param(PatchParam::RxRPN, _id))
-      _settings->set_param(PatchParam::RPN_LSB, value, _id);
-
-  } else if (msgId == 101) {                           // RPN MSB
-    if (_settings->get_param(PatchParam::RxRPN, _id))
-      _settings->set_param(PatchParam::RPN_MSB, value, _id);
-
-  // Channel Mode messages
-  } else if (msgId == 120) {                           // All Sounds Off
-    delete_all_notes();
-
-  } else if (msgId == 121) {                           // Reset All Controllers
-    pitch_bend_change(0x00, 0x40, true);
-    _settings->set_param(PatchParam::PolyKeyPressure, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::ChannelPressure, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::Modulation, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::Expression, 127, (int8_t) _id);
-    _settings->set_param(PatchParam::Hold1, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::Portamento, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::Sostenuto, 0, (int8_t) _id);
-    _settings->set_param(PatchParam::Soft, 0, (int8_t) _id);
-    // RPN & NRPN LSB/MSB -> 0x7f?
-
-  } else if (msgId == 123) {                           // All Notes Off
-    stop_all_notes();
-
-  } else if (msgId == 124) {                           // OMNI Off
-    stop_all_notes();
-
-  } else if (msgId == 125) {                           // OMNI On
-    stop_all_notes();
-
-  } else if (msgId == 126) {                           // Mono (-> Mode 4)
-    stop_all_notes();
-    _settings->set_param(PatchParam::PolyMode, (uint8_t) 0, (int8_t) _id);
-
-  } else if (msgId == 127) {                           // Poly (-> Mode 3)
-    stop_all_notes();
-    _settings->set_param(PatchParam::PolyMode, (uint8_t) 1, (int8_t) _id);
-  }
-
   // Update CC1 and CC2 based on configured controller inputs
   if (_settings->get_param(PatchParam::CC1ControllerNumber, _id) == msgId)
     _settings->set_param(PatchParam::CC1Controller, value, _id);
@@ -481,10 +722,9 @@ int Part::control_change(uint8_t msgId, uint8_t value)
 
 int Part::poly_key_pressure(uint8_t key, uint8_t value)
 {
-  std::cout << "Polyphonic key pressure not implemented (ch="
-	    << _settings->get_param(PatchParam::RxChannel, _id)
-	    << ", key=" << (int) key << ", value=" << value << ")"
-	    << std::endl;
+  LOG_DEBUG("Polyphonic key pressure not implemented (ch=%d, key=%d, "
+	    "value=%d)", _settings->get_param(PatchParam::RxChannel, _id), key,
+	    value);
 
   return 0;
 }
@@ -527,8 +767,6 @@ void Part::reset(void)
 {
   delete_all_notes();
 
-  _partialReserve = 2;
-
   _lastPeakSample = 0;
 }
 
@@ -564,8 +802,7 @@ int Part::set_program(uint8_t index, int8_t bank, bool ignRxFlags)
   } else {
     int dsIndex = _settings->update_drum_set(rhythm - 1, index);
     if (dsIndex < 0) {
-      std::cerr << "libEmuSC: Illegal program for drum set ("
-		<< (int) index << ")" << std::endl;
+      LOG_WARNING("Illegal program for drum set (%d)", index);
       return 0;
     }
 
@@ -592,30 +829,59 @@ void Part::clear_change_callback(void)
 }
 
 
-void Part::set_envelope_callback(std::function<void(const float, const float,
-                                                    const float, const float,
-                                                    const float, const float)> cb)
-{
-  _envelopeCallback = cb;
-}
-
-
-void Part::clear_envelope_callback(void)
+void Part::serialize(StateArchive &a)
 {
-  _envelopeCallback = NULL;
-}
+  _notesMutex->lock();
 
+  try {
+    a.io(_lastPeakSample);
+    a.io(_lastPitchBendRange);
+    a.io(_partBus);
+
+    uint32_t numNotes = _notes.size();
+    a.io(numNotes);
+
+    if (a.loading()) {
+      for (auto n : _notes)
+        delete n;
+      _notes.clear();
+      for (auto &k : _keyNotes)
+        k.clear();
+      _numPartials = 0;
+
+      for (uint32_t i = 0; i < numNotes; i++) {
+        uint8_t key = 0, velocity = 0;
+        uint16_t instrumentIndex = 0;
+        a.io(key);
+        a.io(velocity);
+        a.io(instrumentIndex);
+
+        Note *n = new Note(key, velocity, instrumentIndex, _ctrlRom, _waveRom,
+                           _settings, _id);
+        _notes.push_back(n);
+        _keyNotes[key & 0x7f].push_back(n);
+        _numPartials += n->get_num_partials();
+        n->serialize(a, _ctrlRom, _waveRom);
+      }
 
-void Part::set_lfo_callback(std::function<void(const int, const int, const int)
-                            > cb)
-{
-  _lfoCallback = cb;
-}
+    } else {
+      for (auto n : _notes) {
+        uint8_t key = n->key();
+        uint8_t velocity = n->velocity();
+        uint16_t instrumentIndex = n->instrument_index();
+        a.io(key);
+        a.io(velocity);
+        a.io(instrumentIndex);
+        n->serialize(a, _ctrlRom, _waveRom);
+      }
+    }
 
+  } catch (std::string errorMsg) {
+    _notesMutex->unlock();
+    throw(errorMsg);
+  }
 
-void Part::clear_lfo_callback(void)
-{
-  _lfoCallback = NULL;
+  _notesMutex->unlock();
 }
 
 }
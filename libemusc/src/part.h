@@ -22,8 +22,10 @@
 
 
 #include "control_rom.h"
+#include "history_ring.h"
 #include "note.h"
 #include "settings.h"
+#include "synth.h"
 #include "wave_rom.h"
 
 #include <stdint.h>
@@ -40,7 +42,8 @@ namespace EmuSC {
 class Part
 {
 public:
-  Part(uint8_t id, Settings *settings, ControlRom &cRom, WaveRom &wRom);
+  Part(uint8_t id, Settings *settings, const ControlRom &cRom,
+       const WaveRom &wRom);
   ~Part();
 
   int get_sample_set(std::array<std::array<float, 256>, 2> &dryBus,
@@ -48,8 +51,33 @@ public:
 		     std::array<std::array<float, 256>, 2> &reverbBus);
   void update(void);
 
-  int get_last_peak_sample(void);
-  int get_num_partials(void);
+  // Advance active notes by one control block without generating audio
+  void skip_sample_set(void);
+
+  // Dry output of this part from the last call to get_sample_set()
+  const std::array<std::array<float, 256>, 2> &get_part_bus(void)
+  { return _partBus; }
+
+  // Levels from the last control block. Must be called from the audio
+  // thread, see Synth::get_part_meters()
+  Synth::PartMeter get_meter(void);
+  int get_num_partials(void) { return _numPartials; }
+
+  // Store or recreate all active notes and their runtime state
+  void serialize(StateArchive &a);
+  int get_partial_reserve(void) { return _settings->get_partial_reserve(_id); }
+
+  // Voice stealing: Find and remove the note best suited for being stolen.
+  // Released notes are preferred (quietest first), then the oldest note.
+  struct StealCandidate {
+    bool released;            // All partials are in release phase
+    int level;                // Current TVA envelope level
+    uint32_t age;             // Number of control updates since note on
+  };
+  bool get_steal_candidate(StealCandidate &candidate, bool keepNewest = false);
+  int steal_note(bool keepNewest = false);
+  int delete_newest_note(void);
+  int delete_inaudible_notes(int level);
 
   // MIDI Channel Voice Messages
   int set_program(uint8_t index, int8_t bank = -1, bool ignRxPC = false);
@@ -73,12 +101,10 @@ public:
   // Define callback functions for frontends
   void set_change_callback(std::function<void(const int)> cb);
   void clear_change_callback(void);
-  void set_envelope_callback(std::function<void(const float, const float,
-                                                const float, const float,
-                                                const float, const float)> cb);
-  void clear_envelope_callback(void);
-  void set_lfo_callback(std::function<void(const int, const int, const int)>cb);
-  void clear_lfo_callback(void);
+
+  // Envelopes and LFOs for frontends, see Synth::get_part_telemetry()
+  int get_telemetry(uint64_t &pos, Synth::PartTelemetry *data, int size)
+  { return _telemetry->read(pos, data, size); }
 
 private:
   const uint8_t _id;          // Part id: [0-15] on SC-55, [0-31] on SC-88
@@ -88,9 +114,13 @@ private:
   uint16_t _instrument;       // [0-127] -> variation table
   int8_t _drumSet;            // [0-13] drumSet (SC-55)
 
-  uint8_t _partialReserve;    // [0-24] Default 2
+  int _numPartials;           // Partials used by all notes in _notes
 
   float _lastPeakSample;
+  float _lastRms;
+  int _lastTvaMax;            // Highest TVA level among notes in last block
+
+  std::array<std::array<float, 256>, 2> _partBus;
 
   enum Mode {
     mode_Norm  = 0,
@@ -101,19 +131,25 @@ private:
   struct std::list<Note*> _notes;
   std::mutex *_notesMutex;
 
-  ControlRom &_ctrlRom;
-  WaveRom &_waveRom;
+  // Notes in _notes indexed by key for fast note off
+  std::array<std::vector<Note*>, 128> _keyNotes;
+
+  std::list<Note*>::iterator _find_steal_candidate(bool keepNewest);
+  std::list<Note*>::iterator _delete_note(std::list<Note*>::iterator itr);
+  int _delete_assign_group_notes(uint8_t map, uint8_t group);
+  void _update_meter(void);
+
+  const ControlRom &_ctrlRom;
+  const WaveRom &_waveRom;
 
   // Calculated controller values (minimize number of calculations)
   // TODO: Figure out how to do this properly. Only relevant for pitchBend?
   uint8_t _lastPitchBendRange;
 
-  // Envelopes and LFOs callback for external clients
   std::function<void(const int)> _changeCallback = NULL;
-  std::function<void(const float, const float,
-                     const int, const int,
-                     const float, const float)> _envelopeCallback = NULL;
-  std::function<void(const int, const int, const int)> _lfoCallback = NULL;
+
+  // Envelopes and LFOs for external clients, written once per control block
+  HistoryRing<Synth::PartTelemetry, 256> *_telemetry;
 };
 
 }
@@ -41,6 +41,7 @@
 
 
 #include "partial.h"
+#include "profiler.h"
 
 #include <iostream>
 #include <cmath>
@@ -50,8 +51,9 @@ namespace EmuSC {
 
 
 Partial::Partial(int partialId, uint8_t key, uint8_t velocity,
-		 uint16_t instrumentIndex, ControlRom &ctrlRom, WaveRom &waveRom,
-		 WaveGenerator *LFO1, Settings *settings, int8_t partId)
+		 uint16_t instrumentIndex, const ControlRom &ctrlRom,
+		 const WaveRom &waveRom, WaveGenerator *LFO1, Settings *settings,
+		 int8_t partId)
   : _instPartial(ctrlRom.instrument(instrumentIndex).partials[partialId]),
     _settings(settings),
     _partId(partId),
@@ -81,17 +83,6 @@ Partial::Partial(int partialId, uint8_t key, uint8_t velocity,
   _pcmSamples = &waveRom.samples(sampleIndex).samplesF;
   _waveOscillator = new WaveOscillator(_ctrlSample, _pcmSamples,
                                        std::bind(&Partial::first_run_cb, this));
-
-  // FIXME: A few sample definitions in the SC-55 ROM have loop length >
-  // sample length. This makes EmuSC crash as it loops outside range. The
-  // following hack prevents a crash, but audio is wrong for these samples.
-  // TODO: Figure out why this works on the real hardware.
-  // Example: Concert Cym. (Con_sym), #59 of Orchestra drumkit
-  if (_ctrlSample->loopLen > _ctrlSample->sampleLen) {
-    std::cerr << "libEmuSC: Internal error, loop length > sample length!"
-              << std::endl << " => loop length = sample length" << std::endl;
-    _ctrlSample->loopLen = _ctrlSample->sampleLen;
-  }
 }
 
 
@@ -113,12 +104,20 @@ bool Partial::get_sample_set(std::array<std::array<float, 256>, 2> &dryBus)
     return 1;
 
   std::array<std::array<float, 256>, 2> partialBuf = {};
-  _waveOscillator->get_sample_set(_pitch,
-                                  _settings->get_pitchBend_factor(_partId),
-                                  partialBuf[0]);
-
-  _tvf->apply_sample_set(partialBuf[0]);
-  _tva->apply_sample_set(partialBuf);
+  {
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::Oscillator);
+    _waveOscillator->get_sample_set(_pitch,
+                                    _settings->get_pitchBend_factor(_partId),
+                                    partialBuf[0]);
+  }
+  {
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::TVF);
+    _tvf->apply_sample_set(partialBuf[0]);
+  }
+  {
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::TVA);
+    _tva->apply_sample_set(partialBuf);
+  }
 
   for (int i = 0; i < 256; i++) {
     dryBus[0][i] += partialBuf[0][i];
@@ -129,6 +128,18 @@ bool Partial::get_sample_set(std::array<std::array<float, 256>, 2> &dryBus)
 }
 
 
+// Advance sample position without running oscillator, TVF or TVA
+bool Partial::skip_sample_set(void)
+{
+  if (_tva->finished())
+    return 1;
+
+  _waveOscillator->skip_sample_set(_pitch,
+                                   _settings->get_pitchBend_factor(_partId));
+  return 0;
+}
+
+
 void Partial::stop(void)
 {
   // Ignore note off for uninterruptible drums (set by drum set flag)
@@ -161,4 +172,34 @@ void Partial::first_run_cb(void)
     _tva->set_phase(Envelope::Phase::Terminated);
 }
 
+
+void Partial::serialize(StateArchive &a, const ControlRom &ctrlRom,
+                        const WaveRom &waveRom)
+{
+  a.io(_drumSet);
+  a.io(_drumRxNoteOff);
+  a.io(_pitchAdj);
+
+  _LFO2->serialize(a);
+
+  // Sample set is selected by pitch (key and settings at note on), so the
+  // wave oscillator must be recreated if it differs from the restored one
+  int sampleIndex = _pitch->get_sample_id();
+  _pitch->serialize(a);
+  if (a.loading() && _pitch->get_sample_id() != sampleIndex) {
+    sampleIndex = _pitch->get_sample_id();
+    _ctrlSample = &ctrlRom.sample(sampleIndex);
+    _pcmSamples = &waveRom.samples(sampleIndex).samplesF;
+
+    delete _waveOscillator;
+    _waveOscillator = new WaveOscillator(_ctrlSample, _pcmSamples,
+                                         std::bind(&Partial::first_run_cb,
+                                                   this));
+  }
+
+  _tvf->serialize(a);
+  _tva->serialize(a);
+  _waveOscillator->serialize(a);
+}
+
 }
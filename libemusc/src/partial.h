@@ -42,17 +42,22 @@ class Partial
 {
 public:
   Partial(int partialId, uint8_t key, uint8_t velocity,
-	  uint16_t instrumentIndex, ControlRom &controlRom, WaveRom &waveRom,
-	  WaveGenerator *LFO1, Settings *settings, int8_t partId);
+	  uint16_t instrumentIndex, const ControlRom &controlRom,
+	  const WaveRom &waveRom, WaveGenerator *LFO1, Settings *settings,
+	  int8_t partId);
   ~Partial();
 
   bool get_sample_set(std::array<std::array<float, 256>, 2> &dryBus);
+  bool skip_sample_set(void);
 
   void stop(void);
   void update(void);
 
   void first_run_cb(void);
 
+  void serialize(StateArchive &a, const ControlRom &ctrlRom,
+                 const WaveRom &waveRom);
+
   inline int get_current_lfo(void)
   { if (_LFO2) return _LFO2->value(); return 0; }
   int get_current_pitch(void)
@@ -62,11 +67,18 @@ public:
   int get_current_tva(void)
   { if (_tva) return _tva->get_envelope_value(); return 0;}
 
+  float get_output_gain(void)
+  { if (_tva->finished()) return 0; return _tva->gain(); }
+
+  // True when the TVA envelope has reached (or passed) the release phase
+  bool released(void)
+  { return _tva->finished() || _tva->phase() == Envelope::Phase::Release; }
+
 private:
-  struct ControlRom::InstPartial &_instPartial;
-  struct ControlRom::Sample *_ctrlSample;
+  const struct ControlRom::InstPartial &_instPartial;
+  const struct ControlRom::Sample *_ctrlSample;
 
-  std::vector<float> *_pcmSamples;
+  const std::vector<float> *_pcmSamples;
 
   Settings *_settings;
   int8_t _partId;
@@ -25,6 +25,7 @@
 
 
 #include "pitch.h"
+#include "log.h"
 
 #include <algorithm>
 #include <cmath>
@@ -35,12 +36,7 @@
 namespace EmuSC {
 
 
-int Pitch::_portaTargetPitch = 0;
-std::array<int, 28> Pitch::_portaBasePitch = {};
-int Pitch::_pbpIndex = -1;
-
-
-Pitch::Pitch(ControlRom &ctrlRom, uint16_t instrumentIndex, int partialId,
+Pitch::Pitch(const ControlRom &ctrlRom, uint16_t instrumentIndex, int partialId,
              uint8_t key, uint8_t velocity, WaveGenerator *LFO1,
              WaveGenerator *LFO2, Settings *settings, int8_t partId)
   : Envelope(ctrlRom.lookupTables),
@@ -58,7 +54,10 @@ Pitch::Pitch(ControlRom &ctrlRom, uint16_t instrumentIndex, int partialId,
     _sampleIndex(0xffff),
     _cachedPFineTune(0),
     _settings(settings),
-    _partId(partId)
+    _partId(partId),
+    _portaTargetPitch(settings->portamento().targetPitch),
+    _portaBasePitch(settings->portamento().basePitch),
+    _pbpIndex(settings->portamento().index)
 {
   if (_drumSet)
     _dKey = _settings->get_param(DrumParam::PlayKeyNumber, _drumSet, key);
@@ -190,7 +189,7 @@ void Pitch::update(void)
 {
   // Update LFO depth parameters based on fade-in status
   int index = std::clamp((_instPartial.TVPLFO1Depth & 0x7f) - 0x80 + 2 *
-                         _settings->get_param(PatchParam::VibratoDepth,_partId),
+                         _settings->part_cache(_partId).vibratoDepth,
                          0, 0x7f);
   if (_lfo1FadeComplete) {
     _lfo1Depth = _LUT.LFOTVPDepth[index];
@@ -369,7 +368,7 @@ void Pitch::_init_envelope(uint8_t velocity)
   _portaBasePitch[_pbpIndex] += (_instPartial.finePitch - 0x40) * 10;
   _portaBasePitch[_pbpIndex] = std::max(0, _portaBasePitch[_pbpIndex]);
 
-  int8_t rnd = static_cast<int8_t>((std::rand() % 0xffff) >> 8);
+  int8_t rnd = static_cast<int8_t>((_settings->note_prng().next() & 0xffff) >> 8);
   int16_t delta = ((rnd < 0 ? -rnd : rnd) * _instPartial.randPitch + 0x80) >> 8;
   _portaBasePitch[_pbpIndex] += (rnd < 0 ? -delta : delta) * 10;
   _phaseLevel[4] += (rnd < 0 ? -delta : delta) * 10;
@@ -660,8 +659,7 @@ void Pitch::_iterate_phase(void)
 void Pitch::_init_new_phase(enum Phase newPhase)
 {
   if (newPhase == Phase::Init) {
-    std::cerr << "libEmuSC: Internal error, envelope in illegal state"
-	      << std::endl;
+    LOG_ERROR("Internal error, envelope in illegal state");
     return;
 
   } else if (newPhase == Phase::Attack1 || newPhase == Phase::Attack2 ||
@@ -732,4 +730,41 @@ int Pitch::_calc_phase_inc_from_pitch(int frac)
   return (and3 << 8 | and3 >> 8) + coarse;
 }
 
+
+void Pitch::serialize(StateArchive &a)
+{
+  _serialize_envelope(a);
+
+  a.io(_firstUpdate);
+  a.io(_key);
+  a.io(_dKey);
+  a.io(_drumSet);
+  a.io(_lfo1FadeComplete);
+  a.io(_lfo2FadeComplete);
+  a.io(_lfo1Depth);
+  a.io(_lfo2Depth);
+  a.io(_envTimeKeyFlwT14);
+  a.io(_envTimeKeyFlwT5);
+  a.io(_envTimeVelSens);
+  a.io(_envPhaseRate);
+  a.io(_isAscending);
+  a.io(_envVelSens);
+  a.io(_keyFollowOffset);
+  a.io(_phaseLevel);
+  a.io(_basePitchC);
+  a.io(_basePitchF);
+  a.io(_sampleIndex);
+  a.io(_samplePitchOffsetInit);
+  a.io(_samplePitchOffsetSust);
+  a.io(_samplePitchOffsetActive);
+  a.io(_portamentoDelta);
+  a.io(_releasePitch);
+  a.io(_targetPitch);
+  a.io(_cachedPFineTune);
+  a.io(_cachedPFineTuneOffset);
+  a.io(_phaseIncrement);
+  a.io(_currentInc);
+  a.io(_deltaInc);
+}
+
 }
@@ -37,7 +37,7 @@ namespace EmuSC {
 class Pitch : public Envelope
 {
 public:
-  Pitch(ControlRom &ctrlRom, uint16_t instrumentIndex, int partialId,
+  Pitch(const ControlRom &ctrlRom, uint16_t instrumentIndex, int partialId,
         uint8_t key, uint8_t velocity, WaveGenerator *LFO1, WaveGenerator *LFO2,
         Settings *settings, int8_t partId);
   ~Pitch();
@@ -49,10 +49,18 @@ public:
   inline float get_phase_increment(void) {
     _currentInc += _deltaInc; return _currentInc; }
 
+  // Sum of the next n phase increments, used when skipping samples
+  inline float skip_phase_increments(int n) {
+    float sum = n * _currentInc + _deltaInc * (n * (n + 1) / 2);
+    _currentInc += n * _deltaInc;
+    return sum; }
+
   inline uint16_t get_sample_id(void) { return _sampleIndex; }
 
   void first_sample_run_complete(void);
 
+  void serialize(StateArchive &a);
+
 
 private:
   bool _firstUpdate;
@@ -60,11 +68,11 @@ private:
   int _dKey;                  // MIDI key number for drumsets
   int _drumSet;               // 0 = normal inst., 1 = drumset1, 2 = drumset2
 
-  ControlRom &_ctrlRom;
+  const ControlRom &_ctrlRom;
   uint16_t _instrumentIndex;
 
-  ControlRom::InstPartial &_instPartial;
-  ControlRom::LookupTables &_LUT;
+  const ControlRom::InstPartial &_instPartial;
+  const ControlRom::LookupTables &_LUT;
 
   WaveGenerator *_LFO1;
   WaveGenerator *_LFO2;
@@ -109,12 +117,11 @@ private:
   Settings *_settings;
   int8_t _partId;
 
-  // Portamento pitch values are shared among all voices / instrument partials.
-  // Portamento base pitch is reused in a round robin fashion for all available
-  // voices, while the portamento target pitch is a global target.
-  static int _portaTargetPitch;
-  static std::array<int, 28> _portaBasePitch;
-  static int _pbpIndex;
+  // Portamento pitch values are shared among all voices / instrument partials
+  // in a synth instance and are stored in Settings (see Settings::Portamento)
+  int &_portaTargetPitch;
+  std::array<int, 28> &_portaBasePitch;
+  int &_pbpIndex;
 
   Pitch();
 
@@ -0,0 +1,70 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Small and fast pseudo random number generator (xorshift64*). Each Synth
+// has its own generators so that several instances can run in parallel without
+// sharing the global rand() state, and so that offline renders can be made
+// bit-reproducible by setting a fixed seed.
+
+
+#ifndef __PRNG_H__
+#define __PRNG_H__
+
+
+#include "state_archive.h"
+
+#include <cstdint>
+
+
+namespace EmuSC {
+
+
+class Prng
+{
+public:
+  Prng(uint64_t seed = 1) { set_seed(seed); }
+
+  // Seed is scrambled with splitmix64 to avoid the all-zero state
+  void set_seed(uint64_t seed)
+  {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    _state = z ^ (z >> 31);
+    if (_state == 0)
+      _state = 0x9e3779b97f4a7c15ULL;
+  }
+
+  // Returns 32 random bits
+  inline uint32_t next(void)
+  {
+    _state ^= _state >> 12;
+    _state ^= _state << 25;
+    _state ^= _state >> 27;
+    return static_cast<uint32_t>((_state * 0x2545f4914f6cdd1dULL) >> 32);
+  }
+
+  void serialize(StateArchive &a) { a.io(_state); }
+
+private:
+  uint64_t _state;
+};
+
+}
+
+#endif  // __PRNG_H__
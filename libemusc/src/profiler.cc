@@ -0,0 +1,150 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+
+namespace EmuSC {
+
+
+Profiler::Profiler()
+{
+  _reset();
+}
+
+
+Profiler::~Profiler()
+{}
+
+
+void Profiler::_reset(void)
+{
+  _block.fill(0);
+  _sum.fill(0);
+  _min.fill(std::numeric_limits<uint64_t>::max());
+  _max.fill(0);
+  for (auto &h : _history)
+    h.fill(0);
+
+  _numBlocks = 0;
+  _numRiskBlocks = 0;
+  _blockStart = 0;
+  _activeVoices = 0;
+  _maxActiveVoices = 0;
+}
+
+
+void Profiler::begin_block(void)
+{
+  _block.fill(0);
+  _blockStart = now();
+}
+
+
+void Profiler::end_block(int activeVoices)
+{
+  const uint64_t blockDuration = 256 * 1000000000ULL / 32000;
+
+  _block[static_cast<int>(Stage::Total)] = now() - _blockStart;
+
+  // Never wait for get_stats() in the audio thread, drop the block instead
+  std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+
+  int index = _numBlocks % _historySize;
+  for (int s = 0; s < _numStages; s++) {
+    _sum[s] += _block[s];
+    _min[s] = std::min(_min[s], _block[s]);
+    _max[s] = std::max(_max[s], _block[s]);
+    _history[s][index] = (uint32_t) std::min(_block[s], (uint64_t) UINT32_MAX);
+  }
+
+  if (_block[static_cast<int>(Stage::Total)] > blockDuration * 8 / 10)
+    _numRiskBlocks++;
+
+  _activeVoices = activeVoices;
+  _maxActiveVoices = std::max(_maxActiveVoices, activeVoices);
+  _numBlocks++;
+}
+
+
+Synth::PerfStats Profiler::get_stats(bool reset)
+{
+  const double blockDuration = 256 / 32000.0 * 1000000.0;       // us
+  Synth::PerfStats stats = {};
+
+#ifdef __EMUSC_PROFILER__
+  stats.enabled = true;
+#endif
+
+  // Only copy while locked, as end_block() skips blocks while we hold the lock
+  std::array<uint64_t, _numStages> sum, min, max;
+  std::vector<uint32_t> history;
+  uint64_t numBlocks, numRiskBlocks;
+  int historyLen;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    numBlocks = _numBlocks;
+    numRiskBlocks = _numRiskBlocks;
+    stats.activeVoices = _activeVoices;
+    stats.maxActiveVoices = _maxActiveVoices;
+    sum = _sum;
+    min = _min;
+    max = _max;
+
+    historyLen = std::min(_numBlocks, (uint64_t) _historySize);
+    history.resize(_numStages * historyLen);
+    for (int s = 0; s < _numStages; s++)
+      std::copy(_history[s].begin(), _history[s].begin() + historyLen,
+                history.begin() + s * historyLen);
+
+    if (reset)
+      _reset();
+  }
+
+  stats.blocks = numBlocks;
+  if (numBlocks == 0)
+    return stats;
+
+  for (int s = 0; s < _numStages; s++) {
+    auto first = history.begin() + s * historyLen;
+    int p99Index = (historyLen * 99) / 100;
+    std::nth_element(first, first + p99Index, first + historyLen);
+
+    stats.stages[s].min = min[s] / 1000.0;
+    stats.stages[s].avg = sum[s] / 1000.0 / numBlocks;
+    stats.stages[s].p99 = first[p99Index] / 1000.0;
+    stats.stages[s].max = max[s] / 1000.0;
+  }
+
+  const Synth::PerfStageStats &total =
+    stats.stages[static_cast<int>(Stage::Total)];
+  stats.dspLoad = total.avg / blockDuration;
+  stats.xrunRiskRatio = (double) numRiskBlocks / numBlocks;
+
+  return stats;
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Per-stage render profiler. Only active when libEmuSC is built with the
+// emusc_WITH_PROFILER CMake option (defines __EMUSC_PROFILER__). Otherwise
+// all PROFILE_* macros expand to nothing and no timing code is compiled in.
+//
+// Time is measured with steady_clock in nanoseconds and accumulated per
+// control block (256 samples @ 32 kHz). The last 1024 blocks are kept for
+// calculating percentiles. The audio thread never waits for get_stats(), so
+// blocks ending while statistics are being copied are not counted.
+
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+
+#include "synth.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+
+namespace EmuSC {
+
+
+class Profiler
+{
+public:
+  Profiler();
+  ~Profiler();
+
+  typedef Synth::PerfStage Stage;
+
+  static inline uint64_t now(void)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  inline void add(Stage stage, uint64_t ns)
+  { _block[static_cast<int>(stage)] += ns; }
+
+  void begin_block(void);
+  void end_block(int activeVoices);
+
+  Synth::PerfStats get_stats(bool reset);
+
+  // Measures the time from construction to destruction for one stage
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(Profiler *profiler, Stage stage)
+      : _profiler(profiler), _stage(stage), _start(now()) {}
+    ~ScopedTimer() { if (_profiler) _profiler->add(_stage, now() - _start); }
+
+  private:
+    Profiler *_profiler;
+    Stage _stage;
+    uint64_t _start;
+  };
+
+private:
+  static const int _numStages = static_cast<int>(Stage::Total) + 1;
+  static const int _historySize = 1024;
+
+  std::array<uint64_t, _numStages> _block;        // Current block
+
+  std::array<uint64_t, _numStages> _sum;
+  std::array<uint64_t, _numStages> _min;
+  std::array<uint64_t, _numStages> _max;
+  std::array<std::array<uint32_t, _historySize>, _numStages> _history;
+
+  uint64_t _numBlocks;
+  uint64_t _numRiskBlocks;            // Blocks using > 80% of block duration
+  uint64_t _blockStart;
+  int _activeVoices;
+  int _maxActiveVoices;
+
+  std::mutex _mutex;
+
+  void _reset(void);
+};
+
+
+#ifdef __EMUSC_PROFILER__
+#define PROFILE_SCOPE(profiler, stage) \
+  Profiler::ScopedTimer _profileScope(profiler, stage)
+#define PROFILE_BEGIN_BLOCK(profiler) profiler->begin_block()
+#define PROFILE_END_BLOCK(profiler, voices) profiler->end_block(voices)
+#else
+#define PROFILE_SCOPE(profiler, stage)
+#define PROFILE_BEGIN_BLOCK(profiler)
+#define PROFILE_END_BLOCK(profiler, voices)
+#endif
+
+}
+
+#endif  // __PROFILER_H__
@@ -104,6 +104,21 @@ bool Resampler::get_next_sample(float &outL, float &outR)
 }
 
 
+int Resampler::skip(int samples)
+{
+  int n = 0;
+  for (int i = 0; i < samples; i++) {
+    push(0.0f, 0.0f);
+    while (_readPos + HALF < static_cast<double>(_writeCount)) {
+      _readPos += _ratio;
+      n++;
+    }
+  }
+
+  return n;
+}
+
+
 void Resampler::_buildTable(float cutoff)
 {
   _table.resize((NPHASE + 1) * TAPS);
@@ -162,4 +177,13 @@ double Resampler::_i0(double x)
   return sum;
 }
 
+
+void Resampler::serialize(StateArchive &a)
+{
+  a.io(_readPos);
+  a.io(_writeCount);
+  a.io(_ringL);
+  a.io(_ringR);
+}
+
 }
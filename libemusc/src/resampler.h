@@ -26,6 +26,8 @@
 #define __RESAMPLER_H__
 
 
+#include "state_archive.h"
+
 #include <array>
 #include <vector>
 
@@ -42,6 +44,13 @@ public:
   void push(float left, float right);
   bool get_next_sample(float &outL, float &outR);
 
+  // Push silence and skip the output samples it would produce. Returns the
+  // number of skipped output samples.
+  int skip(int samples);
+
+  // Input history and read position. Sample rate is not included.
+  void serialize(StateArchive &a);
+
   // Filter design parameters
   static constexpr int   HALF   = 16;    // Taps each side
   static constexpr int   NPHASE = 512;   // Polyphase table resolution
@@ -239,4 +239,22 @@ void Reverb::_set_level(int level)
 }
 
 
+void Reverb::serialize(StateArchive &a)
+{
+  a.io(_rBuffer);
+  a.io(_sweepIndex);
+  a.io(_activeCharRegs);
+  a.io(_preLpfState);
+  a.io(_preLpfA);
+  a.io(_preLpfB);
+  a.io(_dampA);
+  a.io(_dampB);
+  a.io(_gLoop);
+  a.io(_outGain);
+  a.io(_character);
+  a.io(_preLPF);
+  a.io(_reverbTime);
+  a.io(_delayFeedback);
+}
+
 }  // namespace EmuSC
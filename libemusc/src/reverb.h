@@ -50,6 +50,8 @@ public:
   void process_sample(float input, float output[2]);
   void update(void);
 
+  void serialize(StateArchive &a);
+
 private:
   Reverb();
 
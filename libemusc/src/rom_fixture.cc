@@ -0,0 +1,586 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// All offsets and table sizes used here must match the SC-55 v1.21 memory
+// map used by ControlRom (SC55_1_21_Prog_LUT & SC55_1_21_CPU_LUT) and the
+// sample decoding in WaveRom.
+
+
+#include "rom_fixture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+
+namespace EmuSC {
+
+
+// Control ROM bank layout for SC-55
+static const uint32_t banks[8] =
+  { 0x10000, 0x1BD00, 0x1DEC0, 0x20000, 0x2BD00, 0x2DEC0, 0x30000, 0x38000 };
+
+// Lookup table positions in control ROM
+static constexpr uint32_t progVelocityCurves = 0x3d1e8;
+static constexpr uint32_t progKeyMapperIndex = 0x3dc72;
+static constexpr uint32_t progKeyMapper      = 0x3dd82;
+
+// Lookup table positions in CPU ROM
+static constexpr uint32_t cpuPitchParamScale      = 0x14c6;
+static constexpr uint32_t cpuEnvTimeKeyFollowSens = 0x679a;
+static constexpr uint32_t cpuEnvTimeScale         = 0x67c6;
+static constexpr uint32_t cpuEnvelopeTime         = 0x6f12;
+static constexpr uint32_t cpuLFORate              = 0x7012;
+static constexpr uint32_t cpuLFODelayTime         = 0x7112;
+static constexpr uint32_t cpuLFOTVFDepth          = 0x7212;
+static constexpr uint32_t cpuLFOTVPDepth          = 0x7312;
+static constexpr uint32_t cpuLFOSine              = 0x7412;
+static constexpr uint32_t cpuTVFCutoffFreqKF      = 0x74d2;
+static constexpr uint32_t cpuTVFCutoffVSens       = 0x74fc;
+static constexpr uint32_t cpuTVFEnvDepth          = 0x7512;
+static constexpr uint32_t cpuTVFCutoffFreq        = 0x7612;
+static constexpr uint32_t cpuTVFResonanceFreq     = 0x7714;
+static constexpr uint32_t cpuTVFResonance         = 0x7816;
+static constexpr uint32_t cpuPitchEnvVelSens1     = 0x78c6;
+static constexpr uint32_t cpuPitchEnvVelSens2     = 0x78dc;
+static constexpr uint32_t cpuPitchEnvDepth        = 0x78f2;
+static constexpr uint32_t cpuTVFEnvScale          = 0x79f2;
+static constexpr uint32_t cpuPortamentoRate       = 0x7a32;
+static constexpr uint32_t cpuEnvSegmentStep       = 0x67ba;
+static constexpr uint32_t cpuEnvSegmentCurve      = 0x6b06;
+static constexpr uint32_t cpuTVAEnvExpChange      = 0x6d10;
+static constexpr uint32_t cpuTVABiasLevel         = 0x69c6;
+static constexpr uint32_t cpuTVAPanpot            = 0x6c8f;
+static constexpr uint32_t cpuTVALevelIndex        = 0x6b0f;
+static constexpr uint32_t cpuTVALevel             = 0x6b8f;
+static constexpr uint32_t cpuPitchFineExp         = 0x7b7a;
+static constexpr uint32_t cpuPitchCoarseExp       = 0x7d7a;
+
+// Wave ROM sample data starts above the nibble shift table
+static constexpr uint32_t waveDataStart = 0x10000;
+static constexpr int waveShift = 7;             // Sample value = delta / 1024
+
+
+RomFixture::RomFixture()
+  : _progRom(0x40000, 0),
+    _cpuRom(0x8000, 0),
+    _waveRom(0x100000, 0)
+{
+  _generate_wave_rom();
+  _generate_prog_rom();
+  _generate_cpu_rom();
+}
+
+
+RomFixture::~RomFixture()
+{}
+
+
+void RomFixture::write(std::string progRomPath, std::string cpuRomPath,
+                       std::string waveRomPath)
+{
+  _write_file(progRomPath, _progRom);
+  _write_file(cpuRomPath, _cpuRom);
+  _write_file(waveRomPath, _waveRom);
+}
+
+
+void RomFixture::_write_file(std::string path, const std::vector<uint8_t> &data)
+{
+  std::ofstream romFile(path, std::ios::binary | std::ios::out);
+  if (!romFile.is_open())
+    throw(std::string("Unable to create ROM fixture file: ") + path);
+
+  romFile.write(reinterpret_cast<const char *>(data.data()), data.size());
+  if (!romFile.good())
+    throw(std::string("Unable to write ROM fixture file: ") + path);
+
+  romFile.close();
+}
+
+
+void RomFixture::_put_uint16(std::vector<uint8_t> &rom, uint32_t pos,
+                             uint16_t value)
+{
+  rom[pos] = value >> 8;
+  rom[pos + 1] = value & 0xff;
+}
+
+
+void RomFixture::_write_name(uint8_t *dst, std::string name)
+{
+  for (int i = 0; i < 12; i++)
+    dst[i] = (i < (int) name.length()) ? name[i] : ' ';
+}
+
+
+// Same bit order as WaveRom::_unscramble_address(): returns the plain address
+// for a given position in the scrambled ROM file
+uint32_t RomFixture::_plain_address(uint32_t address)
+{
+  if (address < 0x20)
+    return address;
+
+  static const int addressOrder [20] =
+    { 0x02, 0x00, 0x03, 0x04,0x01, 0x09, 0x0D, 0x0A, 0x12,
+      0x11, 0x06, 0x0F, 0x0B, 0x10, 0x08, 0x05, 0x0C, 0x07, 0x0E, 0x13 };
+
+  uint32_t newAddress = 0;
+  for (uint32_t bit = 0; bit < 20; bit++)
+    newAddress |= ((address >> addressOrder[bit]) & 1) << bit;
+
+  return newAddress;
+}
+
+
+// Inverse of WaveRom::_unscramble_data()
+uint8_t RomFixture::_scramble_data(uint8_t byte)
+{
+  static const uint8_t byteOrder[8] = {2, 0, 4, 5, 7, 6, 3, 1};
+  uint8_t newByte = 0;
+
+  for (uint32_t bit = 0; bit < 8; bit++)
+    newByte |= ((byte >> bit) & 1) << byteOrder[bit];
+
+  return newByte;
+}
+
+
+void RomFixture::_generate_wave_rom(void)
+{
+  std::vector<uint8_t> plain(0x100000, 0);
+
+  std::memcpy(&plain[0x1c], "0.00", 4);
+  std::memcpy(&plain[0x30], "2026-01-01", 10);
+
+  // Single cycle waveforms use a 64 sample period (500 Hz @ 32 kHz), which is
+  // key 71 + 21.3 cents. The sample data is first played once and then the
+  // last 8 periods are looped.
+  const int sinePitch = 1024 - 213;
+  _sampleDefs = {
+    { Wave::Sine,   0, 64 * 12 - 1, 64 * 8 - 1, 0, 71, sinePitch },
+    { Wave::Saw,    0, 64 * 12 - 1, 64 * 8 - 1, 0, 71, sinePitch },
+    { Wave::Square, 0, 64 * 12 - 1, 64 * 8 - 1, 0, 71, sinePitch },
+    { Wave::Noise,  0, 8191,        8191 - 256, 0, 60, 1024      } };
+
+  uint32_t address = waveDataStart;
+  uint32_t noise = 0x1234567;
+  for (auto &s : _sampleDefs) {
+    s.address = address;
+
+    // Samples are stored as 8 bit deltas with a shared exponent per 16 bytes
+    float level = 0;
+    for (int i = 0; i <= s.sampleLen; i++) {
+      float t = 2 * M_PI * (i % 64) / 64.0;
+      float target = 0;
+      switch (s.wave) {
+      case Wave::Sine:
+        target = 0.5 * std::sin(t);
+        break;
+      case Wave::Saw:
+        for (int h = 1; h <= 10; h++)
+          target += 0.3 * std::sin(h * t) / h;
+        break;
+      case Wave::Square:
+        for (int h = 1; h <= 11; h += 2)
+          target += 0.4 * std::sin(h * t) / h;
+        break;
+      case Wave::Noise:
+        noise = noise * 1103515245 + 12345;
+        target = 0.4 * (((noise >> 16) & 0x7fff) / 16384.0 - 1.0);
+        break;
+      }
+
+      int delta = std::lround((target - level) * (1 << (17 - waveShift)));
+      delta = std::clamp(delta, -128, 127);
+      level += (float) delta / (1 << (17 - waveShift));
+
+      plain[address + i] = (uint8_t) (int8_t) delta;
+    }
+
+    address += (s.sampleLen + 0x100) & ~0xff;
+  }
+
+  // Exponent table: one byte for every 32 bytes, one nibble per 16 bytes
+  for (uint32_t a = waveDataStart >> 5; a < (address >> 5) + 1; a++)
+    plain[a] = (waveShift << 4) | waveShift;
+
+  for (uint32_t i = 0; i < 0x100000; i++)
+    _waveRom[i] = i >= 0x20 ? _scramble_data(plain[_plain_address(i)])
+                            : plain[i];
+}
+
+
+// Fills an instrument partial definition (92 bytes) with neutral values
+static void default_partial(uint8_t *p, uint16_t partialIndex)
+{
+  std::memset(p, 0, 92);
+
+  p[1] = 0x40;                                   // Root key offset
+  p[2] = partialIndex >> 8;
+  p[3] = partialIndex & 0xff;
+  p[5] = 0x40;                                   // LFO2 rate
+  p[6] = 0x20;                                   // LFO2 delay
+  p[7] = 0x20;                                   // LFO2 fade
+  p[8] = 0xff;                                   // TVF flags
+  p[9] = 0x40;                                   // Panpot
+  p[10] = 0x40;                                  // Coarse pitch
+  p[11] = 0x40;                                  // Fine pitch
+  p[13] = 0x4a;                                  // Pitch key follow = 100%
+
+  for (int i = 18; i <= 22; i++)                 // Pitch envelope levels
+    p[i] = 0x40;
+  for (int i = 23; i <= 27; i++)                 // Pitch envelope times
+    p[i] = 0x10;
+  p[32] = p[33] = p[34] = p[35] = 0x40;          // Pitch env. sensitivities
+
+  p[37] = 0x50;                                  // TVF base cutoff
+  p[38] = 0x40;                                  // TVF resonance
+  p[39] = 2;                                     // TVF disabled
+  p[41] = 0x40;                                  // TVF cutoff key follow
+  p[44] = 0x40;                                  // TVF envelope depth
+  for (int i = 45; i <= 49; i++)                 // TVF envelope levels
+    p[i] = 0x40;
+  for (int i = 50; i <= 54; i++)                 // TVF envelope times
+    p[i] = 0x20;
+  p[59] = p[60] = p[61] = p[62] = p[63] = 0x40;  // TVF env. sensitivities
+
+  p[69] = 0x7f;                                  // Volume
+  p[71] = 0x40;                                  // TVA bias level
+  p[74] = 0x7f;                                  // TVA envelope L1 - L4
+  p[75] = 0x7f;
+  p[76] = 0x70;
+  p[77] = 0x70;
+  p[78] = 0x88;                                  // T1, linear
+  p[79] = 0x10;                                  // T2 - T5, exponential
+  p[80] = 0x40;
+  p[81] = 0x50;
+  p[82] = 0x38;
+  p[87] = p[88] = p[89] = p[90] = 0x40;          // TVA env. sensitivities
+}
+
+
+void RomFixture::_write_instrument(int index, std::string name,
+                                   int partialsUsed, uint8_t lfoRate,
+                                   const uint8_t *partial0,
+                                   const uint8_t *partial1)
+{
+  uint32_t x = banks[0] + index * 216;
+  if (x >= banks[1])
+    x = banks[3] + (x - banks[1]);
+
+  _write_name(&_progRom[x], name);
+  _progRom[x + 12] = 0x7f;                       // Volume
+  _progRom[x + 14] = 0;                          // LFO1 waveform (sine)
+  _progRom[x + 15] = lfoRate;
+  _progRom[x + 16] = 0x30;                       // LFO1 delay
+  _progRom[x + 17] = 0x20;                       // LFO1 fade
+  _progRom[x + 18] = partialsUsed;
+  _progRom[x + 19] = 0;                          // No pitch curve
+
+  std::memcpy(&_progRom[x + 32], partial0, 92);
+  std::memcpy(&_progRom[x + 32 + 92], partial1, 92);
+}
+
+
+void RomFixture::_generate_prog_rom(void)
+{
+  const char *version = "Ver0.00 EmuSC ROM fixture";
+  std::memcpy(&_progRom[0xf380], version, std::strlen(version));
+  std::memcpy(&_progRom[0xf380 + 24], "01/26", 5);
+
+  // Samples, one per waveform
+  for (int i = 0; i < (int) _sampleDefs.size(); i++) {
+    const _SampleDef &s = _sampleDefs[i];
+    uint32_t x = banks[2] + i * 16;
+    _progRom[x] = 0x7f;                          // Volume
+    _progRom[x + 1] = (s.address >> 16) & 0xff;
+    _progRom[x + 2] = (s.address >> 8) & 0xff;
+    _progRom[x + 3] = s.address & 0xff;
+    _put_uint16(_progRom, x + 4, 0);             // Portamento offset
+    _put_uint16(_progRom, x + 6, s.sampleLen);
+    _put_uint16(_progRom, x + 8, s.loopLen);
+    _progRom[x + 10] = s.loopMode;
+    _progRom[x + 11] = s.rootKey;
+    _put_uint16(_progRom, x + 12, s.pitch);
+    _put_uint16(_progRom, x + 14, s.pitch);
+  }
+
+  // Partials, one sample each covering the full key range
+  const char *partialNames[] = { "Sine", "Saw", "Square", "Noise" };
+  for (int i = 0; i < (int) _sampleDefs.size(); i++) {
+    uint32_t x = banks[1] + i * 60;
+    _write_name(&_progRom[x], partialNames[i]);
+    for (int b = 0; b < 16; b++) {
+      _progRom[x + 12 + b] = 0x7f;
+      _put_uint16(_progRom, x + 28 + 2 * b, (b == 0) ? i : 0xffff);
+    }
+  }
+
+  // Instruments
+  uint8_t p0[92], p1[92];
+
+  default_partial(p0, 0);
+  _write_instrument(0, "Sine Wave", 1, 0x40, p0, p0);
+
+  default_partial(p0, 1);
+  p0[14] = 0x06;                                 // Vibrato
+  p0[37] = 0x48;                                 // TVF: Low pass w/envelope
+  p0[39] = 0;
+  p0[44] = 0x50;
+  p0[45] = 0x60;
+  p0[46] = 0x58;
+  p0[47] = 0x50;
+  p0[48] = 0x50;
+  _write_instrument(1, "Saw Lead", 1, 0x48, p0, p0);
+
+  default_partial(p0, 2);
+  p0[37] = 0x60;                                 // TVF: Static low pass
+  p0[39] = 0;
+  _write_instrument(2, "Square", 1, 0x40, p0, p0);
+
+  default_partial(p0, 1);
+  p0[11] = 0x43;                                 // Detuned, slow attack
+  p0[14] = 0x0a;
+  p0[78] = 0xd0;
+  p0[82] = 0x50;
+  default_partial(p1, 0);
+  p1[11] = 0x3d;
+  p1[78] = 0xd0;
+  p1[82] = 0x50;
+  _write_instrument(3, "Syn Pad", 3, 0x38, p0, p1);
+
+  default_partial(p0, 2);
+  p0[10] = 0x34;                                 // One octave down
+  p0[37] = 0x40;
+  p0[39] = 0;
+  p0[45] = 0x70;
+  p0[46] = 0x50;
+  p0[47] = 0x48;
+  p0[48] = 0x48;
+  _write_instrument(4, "Syn Bass", 1, 0x40, p0, p0);
+
+  default_partial(p0, 3);                        // Drums: decays to silence
+  p0[37] = 0x50;
+  p0[39] = 1;                                    // TVF: High pass
+  p0[76] = 0x30;
+  p0[77] = 0x00;
+  p0[79] = 0x18;
+  p0[80] = 0x30;
+  p0[81] = 0x30;
+  p0[82] = 0x20;
+  _write_instrument(5, "Noise Hit", 1, 0x40, p0, p0);
+
+  default_partial(p0, 0);
+  p0[10] = 0x28;
+  p0[16] = 0x40;                                 // Pitch envelope drop
+  p0[18] = 0x7f;
+  p0[19] = 0x50;
+  p0[23] = p0[24] = 0x18;
+  p0[76] = 0x30;
+  p0[77] = 0x00;
+  p0[79] = 0x20;
+  p0[80] = 0x38;
+  p0[81] = 0x30;
+  p0[82] = 0x20;
+  _write_instrument(6, "Sine Kick", 1, 0x40, p0, p0);
+
+  // Variations: only the capital tone bank is defined
+  for (int bank = 0; bank < 128; bank++)
+    for (int prog = 0; prog < 128; prog++)
+      _put_uint16(_progRom, banks[6] + (bank * 128 + prog) * 2,
+                  bank == 0 ? prog % numMelodicInstruments : 0xffff);
+
+  // Drum sets: one STANDARD set on program 0, remaining slots unused
+  for (int i = 0; i < 128; i++)
+    _progRom[banks[7] + i] = (i == 0) ? 0 : 0xff;
+
+  for (int ds = 0; ds < 14; ds++) {
+    uint32_t x = banks[7] + 128 + ds * 1164;
+    if (ds > 0) {
+      std::memset(&_progRom[x + 1152], 0xff, 12);
+      continue;
+    }
+
+    for (int key = 0; key < 128; key++) {
+      uint16_t preset = 0xffff;
+      if (key == 35 || key == 36)
+        preset = numMelodicInstruments + 1;
+      else if (key > 36 && key <= 81)
+        preset = numMelodicInstruments;
+
+      _put_uint16(_progRom, x + key * 2, preset);
+      _progRom[x + 256 + key] = 0x64;            // Volume
+      _progRom[x + 384 + key] = key;             // Key
+      _progRom[x + 512 + key] =                  // Assign group (hi-hats)
+        (key == 42 || key == 44 || key == 46) ? 1 : 0;
+      _progRom[x + 640 + key] = 0x40 + ((key % 5) - 2) * 8;
+      _progRom[x + 768 + key] = 0x7f;            // Reverb
+      _progRom[x + 896 + key] = 0x7f;            // Chorus
+      _progRom[x + 1024 + key] = 0x10;           // Rx note on
+    }
+    _write_name(&_progRom[x + 1152], "STANDARD");
+  }
+
+  // Velocity curves: 10 curves from convex to concave
+  for (int c = 0; c < 10; c++)
+    for (int v = 0; v < 128; v++)
+      _progRom[progVelocityCurves + c * 128 + v] =
+        std::lround(127 * std::pow(v / 127.0, 0.5 + c * 0.15));
+
+  // Key mapper. Index tables 0 - 47 and 64 - 95 (TVA bias, TVA/TVF time key
+  // follow) point to an 8 bit map with key 60 at 0x80, 48 - 63 (TVF cutoff key
+  // follow) to a 16 bit map with key 60 at 0x4000, 96 - 119 (pitch curves) to
+  // a flat 16 bit map and 120 - 135 (pitch time key follow) to an 8 bit map.
+  for (int i = 0; i < 136; i++) {
+    int offset = 0;
+    if (i >= 48 && i < 64)
+      offset = 128;
+    else if (i >= 96 && i < 120)
+      offset = 384;
+    else if (i >= 120)
+      offset = 640;
+
+    _put_uint16(_progRom, progKeyMapperIndex + 2 * i,
+                (progKeyMapper - banks[6]) + offset);
+  }
+
+  for (int key = 0; key < 128; key++) {
+    _progRom[progKeyMapper + key] = key + 0x44;
+    _put_uint16(_progRom, progKeyMapper + 128 + 2 * key, 0x4000 + (key - 60) * 0x100);
+    _put_uint16(_progRom, progKeyMapper + 384 + 2 * key, 0x8000);
+    _progRom[progKeyMapper + 640 + key] = key + 0x44;
+  }
+}
+
+
+void RomFixture::_generate_cpu_rom(void)
+{
+  std::vector<uint8_t> &c = _cpuRom;
+
+  // Pitch key follow scale, 0x8000 = 100% (index 10)
+  for (int i = 0; i < 21; i++)
+    _put_uint16(c, cpuPitchParamScale + 2 * i, (i * 0x8000) / 10);
+
+  for (int i = 0; i < 21; i++)
+    c[cpuEnvTimeKeyFollowSens + i] = (i * 128) / 20;
+
+  // Envelope time scale, 0x100 = unity at index 128
+  for (int i = 0; i < 256; i++)
+    _put_uint16(c, cpuEnvTimeScale + 2 * i,
+                std::clamp((int) std::lround(256 * std::pow(2, (i - 128) / 32.0)),
+                           1, 0xffff));
+
+  // Envelope phase time in ms, from 1 ms to ~10 s
+  for (int i = 0; i < 128; i++)
+    _put_uint16(c, cpuEnvelopeTime + 2 * i,
+                std::lround(std::pow(2, i / 9.5)));
+
+  // LFO rate: 5 Hz at 0x40, updated at 125 Hz with a 16 bit phase
+  for (int i = 0; i < 128; i++) {
+    double hz = 5 * std::pow(2, (i - 64) / 16.0);
+    _put_uint16(c, cpuLFORate + 2 * i,
+                std::min((int) std::lround(hz * 65536 / 125), 0x28f6));
+  }
+
+  // LFO delay and fade increments, from immediate to ~5 s
+  for (int i = 0; i < 128; i++) {
+    double s = 0.01 * std::pow(2, i / 14.0);
+    _put_uint16(c, cpuLFODelayTime + 2 * i, (i == 0) ? 0xffff :
+                std::max(1, (int) std::lround(65535 / (s * 125))));
+  }
+
+  for (int i = 0; i < 128; i++) {
+    _put_uint16(c, cpuLFOTVFDepth + 2 * i, i * 32);
+    _put_uint16(c, cpuLFOTVPDepth + 2 * i, i * 16);
+  }
+
+  // LFO sine, half period
+  for (int i = 0; i < 130; i++)
+    c[cpuLFOSine + i] = std::max(0, (int) std::lround(255 * std::sin(M_PI * i / 128)));
+
+  for (int i = 0; i < 21; i++)
+    _put_uint16(c, cpuTVFCutoffFreqKF + 2 * i, std::lround(i * 27.3));
+  for (int i = 0; i < 11; i++)
+    _put_uint16(c, cpuTVFCutoffVSens + 2 * i, i * 20);
+  for (int i = 0; i < 128; i++)
+    _put_uint16(c, cpuTVFEnvDepth + 2 * i, i * 128);
+
+  // TVF cutoff frequency. Kept below the stability limit of the SVF
+  for (int i = 0; i < 129; i++)
+    _put_uint16(c, cpuTVFCutoffFreq + 2 * i,
+                std::lround(0x80 * std::pow(2, i * 6.8 / 128)));
+
+  for (int i = 0; i < 256; i++)
+    c[cpuTVFResonanceFreq + i] = 0x7f;
+  for (int i = 0; i < 128; i++)
+    c[cpuTVFResonance + i] = 0xe6;
+
+  for (int i = 0; i < 11; i++) {
+    _put_uint16(c, cpuPitchEnvVelSens1 + 2 * i, i * 0x100);
+    _put_uint16(c, cpuPitchEnvVelSens2 + 2 * i, i * 0x40);
+  }
+  for (int i = 0; i < 128; i++)
+    _put_uint16(c, cpuPitchEnvDepth + 2 * i, i * 128);
+  for (int i = 0; i < 64; i++)
+    c[cpuTVFEnvScale + i] = i * 4;
+
+  for (int i = 0; i < 128; i++)
+    _put_uint16(c, cpuPortamentoRate + 2 * i,
+                std::lround(16000 / std::pow(2, i / 16.0)));
+
+  for (int i = 0; i < 12; i++)
+    c[cpuEnvSegmentStep + i] = i << 4;
+  for (int i = 0; i < 9; i++)
+    c[cpuEnvSegmentCurve + i] = std::min(i, 7);
+
+  // Exponential envelope segments
+  for (int i = 0; i < 257; i++)
+    _put_uint16(c, cpuTVAEnvExpChange + 2 * i,
+                std::lround(0xffff * (1 - std::exp(-4.0 * std::min(i, 256) / 256)) /
+                            (1 - std::exp(-4.0))));
+
+  for (int i = 0; i < 130; i++)
+    c[cpuTVABiasLevel + i] = std::min(i, 0x7f);
+
+  // Panpot gain (0 - 127) for left channel, right channel reads reversed
+  for (int i = 0; i < 129; i++)
+    c[cpuTVAPanpot + i] = std::lround(127 * std::cos(M_PI / 2 * i / 128));
+
+  // TVA levels: attenuation in 0.375 dB steps
+  for (int i = 0; i < 128; i++)
+    c[cpuTVALevelIndex + i] = (i == 0) ? 0xff :
+      std::min(0xff, (int) std::lround(-40 * std::log10(i / 127.0) / 0.375));
+  for (int i = 0; i < 256; i++)
+    c[cpuTVALevel + i] = std::lround(255 * std::pow(10, -(255 - i) * 0.375 / 20));
+
+  // Pitch to phase increment, see Pitch::_calc_phase_inc_from_pitch()
+  for (int i = 0; i < 256; i++)
+    _put_uint16(c, cpuPitchFineExp + 2 * i,
+                std::lround(4194304 * (std::pow(2, i / 12000.0) - 1)));
+  for (int i = 0; i < 47; i++)
+    _put_uint16(c, cpuPitchCoarseExp + 2 * i,
+                std::lround(0x8000 * std::pow(2, i * 256 / 12000.0)));
+}
+
+}
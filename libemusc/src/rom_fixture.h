@@ -0,0 +1,98 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Synthetic ROM fixture. Generates structurally valid SC-55 control ROM (v1.21
+// memory layout), CPU ROM and wave ROM images containing a handful of simple
+// instruments, partials, looped samples, a drum set and all lookup tables.
+// The images are loaded through the regular ControlRom and WaveRom parsers,
+// which makes it possible to run benchmarks and regression tests without the
+// proprietary Roland ROM files. The generated sound is obviously nothing like
+// a real Sound Canvas.
+//
+// The images can also be written to disk with the emusc-romgen tool.
+
+
+#ifndef __ROM_FIXTURE_H__
+#define __ROM_FIXTURE_H__
+
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+
+namespace EmuSC {
+
+class RomFixture
+{
+public:
+  RomFixture();
+  ~RomFixture();
+
+  // Write all three ROM images to the given paths. Throws std::string on error
+  void write(std::string progRomPath, std::string cpuRomPath,
+             std::string waveRomPath);
+
+  const std::vector<uint8_t> &prog_rom(void) { return _progRom; }
+  const std::vector<uint8_t> &cpu_rom(void) { return _cpuRom; }
+  const std::vector<uint8_t> &wave_rom(void) { return _waveRom; }
+
+  // Melodic instruments are mapped to program % numMelodicInstruments in the
+  // capital tone bank. Drum set 0 (STANDARD) uses the remaining instruments.
+  static constexpr int numMelodicInstruments = 5;
+
+private:
+  std::vector<uint8_t> _progRom;      // 256 kB, unencrypted
+  std::vector<uint8_t> _cpuRom;       // 32 kB
+  std::vector<uint8_t> _waveRom;      // 1 MB, scrambled
+
+  // Sample waveforms defined in the wave ROM
+  enum class Wave { Sine, Saw, Square, Noise };
+
+  struct _SampleDef {
+    Wave wave;
+    uint32_t address;
+    uint16_t sampleLen;
+    uint16_t loopLen;
+    uint8_t loopMode;
+    uint8_t rootKey;
+    uint16_t pitch;
+  };
+  std::vector<_SampleDef> _sampleDefs;
+
+  void _generate_wave_rom(void);
+  void _generate_prog_rom(void);
+  void _generate_cpu_rom(void);
+
+  void _write_instrument(int index, std::string name, int partialsUsed,
+                         uint8_t lfoRate, const uint8_t *partial0,
+                         const uint8_t *partial1);
+  void _write_name(uint8_t *dst, std::string name);
+
+  void _put_uint16(std::vector<uint8_t> &rom, uint32_t pos, uint16_t value);
+
+  static uint32_t _plain_address(uint32_t address);
+  static uint8_t _scramble_data(uint8_t byte);
+
+  void _write_file(std::string path, const std::vector<uint8_t> &data);
+};
+
+}
+
+#endif  // __ROM_FIXTURE_H__
@@ -18,15 +18,19 @@
 
 
 #include "settings.h"
+#include "log.h"
 #include "config.h"
 
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <thread>
 
 
 namespace EmuSC {
@@ -36,10 +40,17 @@ constexpr std::array<uint8_t, 16> Settings::_convert_to_roland_part_id_LUT;
 constexpr std::array<uint8_t, 16> Settings::_convert_from_roland_part_id_LUT;
 
 
-Settings::Settings(ControlRom &ctrlRom)
+Settings::Settings(const ControlRom &ctrlRom)
   : _ctrlRom(ctrlRom),
     _sampleRate(44100),
-    _channels(2)
+    _channels(2),
+    _audibilityFloor(std::pow(10.0f, -96 / 20.0f)),
+    _profiler(NULL),
+    _channelPartsDirty(true),
+    _partCacheDirty(0xffff),
+    _effectsGeneration(1),
+    _paramsWriters(0),
+    _paramsVersion(1)
 {
   // TODO: Add SC-55/88 to master settings
   _initialize_system_params();
@@ -160,6 +171,19 @@ uint8_t Settings::get_patch_param(uint16_t address, int8_t part)
 }
 
 
+// Partial reserve is stored as one byte per part (in Roland part order) in
+// the common patch parameter block
+uint8_t Settings::get_partial_reserve(int8_t part)
+{
+  if (part < 0 || part > 15)
+    return 0;
+
+  int8_t rolandPart = _convert_to_roland_part_id_LUT[part];
+
+  return _patchParams[(int) PatchParam::PartialReserve + rolandPart];
+}
+
+
 uint8_t Settings::get_param(enum DrumParam dp, uint8_t map, uint8_t key)
 {
   return (uint8_t) _drumParams[(int) dp | (map << 12) | key];
@@ -172,21 +196,59 @@ int8_t* Settings::get_param_ptr(enum DrumParam dp, uint8_t map)
 }
 
 
+// A writer may be active in the MIDI or audio thread while the snapshot is
+// copied. The copy is retried until no writes were in progress or completed
+// while copying, similar to a seqlock with multiple writers.
+bool Settings::snapshot_params(uint32_t &version,
+                               std::array<uint8_t, 0x0100> &systemParams,
+                               std::array<uint8_t, 0x4000> &patchParams,
+                               std::array<uint8_t, 0x2000> &drumParams)
+{
+  for (;;) {
+    uint32_t writers = _paramsWriters.load(std::memory_order_acquire);
+    uint32_t v = _paramsVersion.load(std::memory_order_acquire);
+    if (writers == 0 && v == version)
+      return false;
+
+    if (writers != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    systemParams = _systemParams;
+    patchParams = _patchParams;
+    drumParams = _drumParams;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_paramsWriters.load(std::memory_order_acquire) == 0 &&
+        _paramsVersion.load(std::memory_order_relaxed) == v) {
+      version = v;
+      return true;
+    }
+  }
+}
+
+
 void Settings::set_param(enum SystemParam sp, uint8_t value)
 {
+  _begin_write();
   _systemParams[(int) sp] = value;
+  _end_write();
 }
 
 
 void Settings::set_param(enum SystemParam sp, uint8_t *value, uint8_t size)
 {
+  _begin_write();
   for (int i = 0; i < size; i++)
     _systemParams[(int) sp + i] = value[i];
+  _end_write();
 }
 
 
 void Settings::set_param_uint32(enum SystemParam sp, uint32_t value)
 {
+  _begin_write();
   if (_le_native()) {
     _systemParams[(int) sp + 0] = (value >> 24) & 0xff;
     _systemParams[(int) sp + 1] = (value >> 16) & 0xff;
@@ -199,11 +261,13 @@ void Settings::set_param_uint32(enum SystemParam sp, uint32_t value)
     _systemParams[(int) sp + 2] = (value >> 16) & 0xff;
     _systemParams[(int) sp + 3] = (value >> 24) & 0xff;
   }
+  _end_write();
 }
 
 
 void Settings::set_param_32nib(enum SystemParam sp, uint16_t value)
 {
+  _begin_write();
   if (_le_native()) {
     _systemParams[(int) sp + 0] = ((value >> 8) & 0xf0) >> 4;
     _systemParams[(int) sp + 1] = ((value >> 8) & 0x0f) >> 0;
@@ -216,24 +280,32 @@ void Settings::set_param_32nib(enum SystemParam sp, uint16_t value)
     _systemParams[(int) sp + 1] = ((value >> 0) & 0xf0) >> 4;
     _systemParams[(int) sp + 0] = ((value >> 0) & 0x0f) >> 0;
   }
+  _end_write();
 }
 
 
 void Settings::set_system_param(uint16_t address, uint8_t *value, uint8_t size)
 {
-  for (int i = 0; i < size; i++)
-    _systemParams[address + i] = value[i];
+  if (address + size > _systemParams.size())
+    return;
+
+  _begin_write();
+  std::memcpy(&_systemParams[address], value, size);
+  _end_write();
 }
 
 
 void Settings::set_param(enum PatchParam pp, uint8_t value, int8_t part)
 {
+  _begin_write();
   if (part < 0 || part > 15) {
     _patchParams[(int) pp] = value;
+    _invalidate_effects((int) pp);
   } else {
     int8_t rolandPart = _convert_to_roland_part_id_LUT[part];
     _patchParams[(((int) pp) | (rolandPart << 8))] = value;
   }
+  _invalidate_part_cache(part);
 
   if (pp == EmuSC::PatchParam::ChorusMacro) {
     _run_macro_chorus(value);
@@ -244,7 +316,10 @@ void Settings::set_param(enum PatchParam pp, uint8_t value, int8_t part)
   // across all controller paramters for that part
   } else if ((int) pp >= 0x1080 && (int) pp <= 0x1086) {
     _update_controller_input(pp, value, part);
+  } else if (pp == EmuSC::PatchParam::RxChannel) {
+    _channelPartsDirty = true;
   }
+  _end_write();
 
   // Send part updates for frontends
   // To avoid double update on instrument updates we can ignore ToneNumber2
@@ -256,6 +331,7 @@ void Settings::set_param(enum PatchParam pp, uint8_t value, int8_t part)
 void Settings::set_param(enum PatchParam pp, uint8_t *data, uint8_t size,
 			 int8_t part)
 {
+  _begin_write();
   int8_t rolandPart = _convert_to_roland_part_id_LUT[part];
 
   for (int i = 0; i < size; i++) {
@@ -266,11 +342,18 @@ void Settings::set_param(enum PatchParam pp, uint8_t *data, uint8_t size,
       _patchParams[(((int) pp) | (rolandPart << 8)) + i] = data[i];   
     }
   }
+
+  if (part < 0 || part > 15)
+    _invalidate_effects((int) pp, size);
+  _channelPartsDirty = true;
+  _invalidate_part_cache(part);
+  _end_write();
 }
 
 
 void Settings::set_param_uint14(enum PatchParam pp, uint16_t value, int8_t part)
 {
+  _begin_write();
   int8_t rolandPart = 0;
 
   if (part >= 0 && part <= 15)
@@ -284,11 +367,15 @@ void Settings::set_param_uint14(enum PatchParam pp, uint16_t value, int8_t part)
     _patchParams[(int) pp | (rolandPart << 8) + 0] = (value >> 0) & 0x7f;
     _patchParams[(int) pp | (rolandPart << 8) + 1] = (value >> 7) & 0x7f;
   }
+
+  _invalidate_part_cache(part);
+  _end_write();
 }
 
 
 void Settings::set_param_nib16(enum PatchParam pp, uint8_t value, int8_t part)
 {
+  _begin_write();
   int8_t rolandPart = 0;
 
   if (part >= 0 && part <= 15)
@@ -303,30 +390,51 @@ void Settings::set_param_nib16(enum PatchParam pp, uint8_t value, int8_t part)
     _patchParams[address + 0] = (value & 0x0f);
     _patchParams[address + 1] = ((value & 0xf0) >> 4) & 0x0f;
   }
+
+  _invalidate_part_cache(part);
+  _end_write();
 }
 
 
+// Bulk write of patch parameters. Macros are run before the data is copied,
+// so that parameters following a macro in the same write take precedence.
 void Settings::set_patch_param(uint16_t address, uint8_t *data, uint8_t size)
 {
-  for (int i = 0; i < size; i++)
-    _patchParams[address + i] = data[i];
+  if (address + size > _patchParams.size())
+    return;
 
-  if (address == 0x138 && size >= 1) {
-    _run_macro_chorus(data[0]);
-  } else if (address == 0x130 && size >= 1) {
-    _run_macro_reverb(data[0]);
-  }
+  _begin_write();
+  int reverbMacro = (int) PatchParam::ReverbMacro - address;
+  if (reverbMacro >= 0 && reverbMacro < size)
+    _run_macro_reverb(data[reverbMacro]);
+
+  int chorusMacro = (int) PatchParam::ChorusMacro - address;
+  if (chorusMacro >= 0 && chorusMacro < size)
+    _run_macro_chorus(data[chorusMacro]);
+
+  std::memcpy(&_patchParams[address], data, size);
+
+  _channelPartsDirty = true;
+  _invalidate_part_cache();
+  _invalidate_effects(address, size);
+  _end_write();
 }
 
 
 void Settings::set_patch_param(uint16_t address, uint8_t value, int8_t part)
 {
+  _begin_write();
   if (part < 0 || part > 15) {
     _patchParams[address] = value;
+    _invalidate_effects(address);
   } else {
     int8_t rolandPart = _convert_to_roland_part_id_LUT[part];
     _patchParams[(address | (rolandPart << 8))] = value;
   }
+
+  _channelPartsDirty = true;
+  _invalidate_part_cache(part);
+  _end_write();
 }
 
 
@@ -335,7 +443,9 @@ void Settings::set_param(enum DrumParam dp, uint8_t map, uint8_t key, uint8_t va
   if (map > 1 || key > 127)
     return;
 
+  _begin_write();
   _drumParams[(int) dp | (map << 12) | key] = value;
+  _end_write();
 }
 
 
@@ -347,8 +457,10 @@ void Settings::set_param(enum DrumParam dp, uint8_t map, uint8_t *data,
 
   length = (length > 12) ? 12 : length;
 
+  _begin_write();
   for (int i = 0; i < length; i++)
     _drumParams[(int) DrumParam::DrumsMapName + i | (map << 12)] = data[i];
+  _end_write();
 }
 
 
@@ -357,8 +469,9 @@ void Settings::set_drum_param(uint16_t address, uint8_t *data, uint8_t size)
   if (address + size > _drumParams.size())
     return;
 
-  for (int i = 0; i < size; i++)
-    _drumParams[address + i] = data[i];
+  _begin_write();
+  std::memcpy(&_drumParams[address], data, size);
+  _end_write();
 }
 
 
@@ -619,6 +732,10 @@ void Settings::_initialize_patch_params(enum Mode m)
     _patchParams[(int) PatchParam::PitchCoarseTune | (partAddr << 8)] = 0x40;
     _patchParams[(int) PatchParam::Mute            | (partAddr << 8)] = 0x00;
   }
+
+  _channelPartsDirty = true;
+  _invalidate_part_cache();
+  _invalidate_effects();
 }
 
 
@@ -632,16 +749,20 @@ void Settings::_initialize_drumSet_params(void)
 
 void Settings::set_gm_mode(void)
 {
+  _begin_write();
   for (int p = 0; p < 16; p ++) {           // TODO: Support SC-88 with 32 parts
     uint8_t partAddr = _convert_to_roland_part_id_LUT[p];
     _patchParams[(int) PatchParam::RxNRPN       | (partAddr << 8)] = 0x0;
     _patchParams[(int) PatchParam::RxBankSelect | (partAddr << 8)] = 0x0;
   }
+  _invalidate_part_cache();
+  _end_write();
 }
 
 
 void Settings::set_map_mt32(void)
 {
+  _begin_write();
   uint8_t partAddr = _convert_to_roland_part_id_LUT[0];
   _patchParams[(int) PatchParam::ToneNumber      | (partAddr << 8)] = 0x7f;
   _patchParams[(int) PatchParam::ToneNumber + 1  | (partAddr << 8)] = 0x00;
@@ -702,6 +823,8 @@ void Settings::set_map_mt32(void)
   _patchParams[(int) PatchParam::ToneNumber + 1  | (partAddr << 8)] = 0x7f;
   _patchParams[(int) PatchParam::PartPanpot      | (partAddr << 8)] = 0x40;
   _patchParams[(int) PatchParam::ReverbSendLevel | (partAddr << 8)] = 0x40;
+  _invalidate_part_cache();
+  _end_write();
 }
 
 
@@ -725,6 +848,7 @@ int Settings::update_drum_set(uint8_t map, uint8_t bank)
 
   // On the original hardware both the active drum set configurations are
   // copied from ROM to RAM where they can be modified by the user
+  _begin_write();
   for (unsigned int i = 0; i < 12; i ++) {
     if (i < _ctrlRom.drumSet(index).name.length()) {
       _drumParams[(int) DrumParam::DrumsMapName + i |(map << 12)] =
@@ -751,6 +875,7 @@ int Settings::update_drum_set(uint8_t map, uint8_t bank)
     _drumParams[(int) DrumParam::RxNoteOn          | (map << 12) | r] =
       _ctrlRom.drumSet(index).flags[r] & 0x10;
   }
+  _end_write();
 
   return index;
 }
@@ -758,20 +883,54 @@ int Settings::update_drum_set(uint8_t map, uint8_t bank)
 
 bool Settings::load(std::string filePath)
 {
-  return 0;
+  std::ifstream file(filePath, std::ios::binary | std::ios::in);
+  if (!file.is_open())
+    return false;
+
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+
+  // Verify size first to avoid partially loaded settings
+  StateArchive current;
+  current.tag(_fileTag);
+  serialize(current);
+  if (data.size() != current.data().size())
+    return false;
+
+  try {
+    StateArchive a(data);
+    a.tag(_fileTag);
+    serialize(a);
+  } catch (std::string errorMsg) {
+    return false;
+  }
+
+  return true;
 }
 
 
 bool Settings::save(std::string filePath)
 {
-  return 0;
+  StateArchive a;
+  a.tag(_fileTag);
+  serialize(a);
+
+  std::ofstream file(filePath, std::ios::binary | std::ios::out);
+  if (!file.is_open())
+    return false;
+
+  file.write(reinterpret_cast<const char *>(a.data().data()), a.data().size());
+
+  return file.good();
 }
 
 void Settings::reset(void)
 {
+  _begin_write();
   _initialize_system_params();
   _initialize_patch_params();
   _initialize_drumSet_params();
+  _end_write();
 }
 
 
@@ -976,7 +1135,7 @@ void Settings::_update_controller_input(enum PatchParam pp, int value, int part)
       ctrlInt = static_cast<int>(Controller::CC2);
       break;
     default:
-      std::cerr << "libEmuSC: Internal error (unkown controller)" << std::endl;
+      LOG_ERROR("Internal error (unkown controller)");
       return;
   }
 
@@ -1122,4 +1281,66 @@ void Settings::clear_part_callback(void)
 }
 
 
+void Settings::serialize(StateArchive &a)
+{
+  _begin_write();
+  a.io(_systemParams);
+  a.io(_patchParams);
+  a.io(_drumParams);
+  a.io(_controlParams);
+  a.io(_accControlParams);
+  a.io(_PBController);
+
+  _channelPartsDirty = true;
+  _invalidate_part_cache();
+  _invalidate_effects();
+  _end_write();
+}
+
+
+void Settings::set_random_seed(uint64_t seed)
+{
+  _notePrng.set_seed(seed);
+  for (int p = 0; p < 16; p++)
+    _partPrng[p].set_seed(seed + 1 + p);
+}
+
+
+void Settings::serialize_prng(StateArchive &a)
+{
+  _notePrng.serialize(a);
+  for (auto &p : _partPrng)
+    p.serialize(a);
+}
+
+
+void Settings::_update_part_cache(int8_t part)
+{
+  _partCacheDirty &= ~(1 << part);
+
+  PartCache &c = _partCache[part];
+  c.chorusSend = get_param(PatchParam::ChorusSendLevel, part) / 128.0f;
+  c.reverbSend = get_param(PatchParam::ReverbSendLevel, part) / 128.0f;
+  c.pitchBendRange = get_param(PatchParam::PB_PitchControl, part) - 0x40;
+  c.vibratoRate = get_param(PatchParam::VibratoRate, part) - 0x40;
+  c.vibratoDepth = get_param(PatchParam::VibratoDepth, part);
+  c.expression = get_param(PatchParam::Expression, part);
+  c.partLevel = get_param(PatchParam::PartLevel, part);
+  c.panpot = get_param(PatchParam::PartPanpot, part);
+  c.keyRangeLow = get_param(PatchParam::KeyRangeLow, part);
+  c.keyRangeHigh = get_param(PatchParam::KeyRangeHigh, part);
+  c.mute = get_param(PatchParam::Mute, part);
+}
+
+
+void Settings::_update_channel_parts(void)
+{
+  _channelParts.fill(0);
+  for (int p = 0; p < 16; p++) {
+    uint8_t channel = get_param(PatchParam::RxChannel, p);
+    if (channel < 16)
+      _channelParts[channel] |= 1 << p;
+  }
+}
+
 }
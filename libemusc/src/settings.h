@@ -23,21 +23,26 @@
 
 #include "control_rom.h"
 #include "params.h"
+#include "prng.h"
+#include "state_archive.h"
 
 #include <cstdint>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <functional>
 #include <string>
 
 
 namespace EmuSC {
 
+class Profiler;
+
 class Settings
 {
 public:
-  Settings(ControlRom & ctrlRom);
+  Settings(const ControlRom & ctrlRom);
   ~Settings();
 
   // Sound Canvas modes
@@ -83,9 +88,52 @@ public:
   uint16_t get_param_uint16(enum PatchParam pp, int8_t part = -1);
   uint8_t  get_param_nib16(enum PatchParam pp, int8_t part = -1);
   uint8_t  get_patch_param(uint16_t address, int8_t part = -1);
+  uint8_t  get_partial_reserve(int8_t part);
   uint8_t  get_param(enum DrumParam, uint8_t map, uint8_t key);
   int8_t* get_param_ptr(enum DrumParam, uint8_t map);
 
+  // Parts receiving on a MIDI channel as a bitmask (bit n => part n). Rebuilt
+  // on first use after RxChannel has changed. Note that changing RxChannel
+  // through get_param_ptr() is not detected.
+  inline uint32_t get_channel_parts(uint8_t channel) {
+    if (_channelPartsDirty.exchange(false)) _update_channel_parts();
+    return _channelParts[channel & 0x0f]; }
+
+  // Part parameters read while rendering, resolved once from the patch
+  // parameters and refreshed on first read after a patch parameter write.
+  // Must be called with the notes mutex of the part locked, as that is what
+  // keeps the MIDI and audio threads from refreshing an entry concurrently.
+  struct PartCache {
+    float chorusSend;               // Chorus send level [0, 1)
+    float reverbSend;               // Reverb send level [0, 1)
+    int pitchBendRange;             // Semitones
+    int vibratoRate;                // Offset [-64, 63]
+    int vibratoDepth;               // [0, 127]
+    int expression;                 // [0, 127]
+    int partLevel;                  // [0, 127]
+    int panpot;                     // [0, 127], 0 => random
+    uint8_t keyRangeLow;
+    uint8_t keyRangeHigh;
+    bool mute;
+  };
+  inline const PartCache &part_cache(int8_t part) {
+    if (_partCacheDirty.load(std::memory_order_acquire) & (1 << part))
+      _update_part_cache(part);
+    return _partCache[part]; }
+
+  // Incremented on every write to the reverb and chorus parameters. Effects
+  // only need to be recalculated when this value has changed.
+  inline uint32_t effects_generation(void)
+  { return _effectsGeneration.load(std::memory_order_acquire); }
+
+  // Consistent copy of all system, patch and drum parameters that never
+  // blocks writers. Returns false, without copying, if parameters are
+  // unchanged since version.
+  bool snapshot_params(uint32_t &version,
+                       std::array<uint8_t, 0x0100> &systemParams,
+                       std::array<uint8_t, 0x4000> &patchParams,
+                       std::array<uint8_t, 0x2000> &drumParams);
+
   // Set settings from Config paramters
   void set_param(enum SystemParam sp, uint8_t value);
   void set_param(enum SystemParam sp, uint8_t *data, uint8_t size);
@@ -121,6 +169,8 @@ public:
   float get_pitchBend_factor(int8_t part) { return _PBController[part]; }
 
   static int8_t convert_from_roland_part_id(int8_t part);
+  static inline int8_t convert_to_roland_part_id(int8_t part)
+  { return _convert_to_roland_part_id_LUT[part & 0x0f]; }
 
   void set_sample_rate(int sampleRate) { _sampleRate = sampleRate; }
   inline int sample_rate(void) { return _sampleRate; }
@@ -128,6 +178,34 @@ public:
   void set_channels(int channels) { _channels = channels; }
   inline int channels(void) { return _channels; }
 
+  void set_profiler(Profiler *profiler) { _profiler = profiler; }
+  inline Profiler *profiler(void) { return _profiler; }
+
+  // Random number generators for this synth instance. Notes draw from
+  // note_prng() when created (MIDI thread, midiMutex locked), while LFOs draw
+  // from part_prng() (notes mutex of the part locked). The MIDI and audio
+  // threads therefore never advance the same generator.
+  inline Prng &note_prng(void) { return _notePrng; }
+  inline Prng &part_prng(int8_t part) { return _partPrng[part & 0x0f]; }
+  void set_random_seed(uint64_t seed);
+  void serialize_prng(StateArchive &a);
+
+  // Portamento base pitch is reused in a round robin fashion for all voices,
+  // while the portamento target pitch is a global target
+  struct Portamento {
+    int targetPitch = 0;
+    std::array<int, 28> basePitch = {};
+    int index = -1;
+  };
+  inline Portamento &portamento(void) { return _portamento; }
+
+  // All parameters and controller values. Random generator is not included.
+  void serialize(StateArchive &a);
+
+  // Linear gain below which released notes are removed. 0 => disabled
+  void set_audibility_floor(float gain) { _audibilityFloor = gain; }
+  inline float audibility_floor(void) { return _audibilityFloor; }
+
   int get_acc_control_param(enum ControllerParam cp, int part)
   { part = std::clamp(part, 0, 15);
     return _accControlParams[part][static_cast<int>(cp)]; }
@@ -136,23 +214,55 @@ public:
   void clear_part_callback(void);
 
 private:
-  std::array<uint8_t, 0x0100> _systemParams;  // Both SysEx and non-SysEx data
-  std::array<uint8_t, 0x4000> _patchParams;
-  std::array<uint8_t, 0x2000> _drumParams;
+  std::array<uint8_t, 0x0100> _systemParams{};  // Both SysEx and non-SysEx data
+  std::array<uint8_t, 0x4000> _patchParams{};
+  std::array<uint8_t, 0x2000> _drumParams{};
 
   // Controller paramter values generated when controllers change - all parts
   std::array<std::array<std::array<int, 6>, 11>, 16> _controlParams{{{}}};
   // Accumulated controller parameter values per value category - all parts
   std::array<std::array<int16_t, 11>, 16> _accControlParams{{}};
 
-  ControlRom &_ctrlRom;
+  const ControlRom &_ctrlRom;
 
   // Non-native parameters
   int _sampleRate;
   int _channels;                        // 1 => mono or 2 => stereo
+  float _audibilityFloor;               // Linear gain, default -96 dBFS
+  Profiler *_profiler;            // NULL if not profiling
+  Prng _notePrng;
+  std::array<Prng, 16> _partPrng;
+  Portamento _portamento;
 
   std::function<void(const int)> _partCallback = NULL;
 
+  std::array<uint32_t, 16> _channelParts{};
+  std::atomic<bool> _channelPartsDirty;
+  void _update_channel_parts(void);
+
+  std::array<PartCache, 16> _partCache{};
+  std::atomic<uint32_t> _partCacheDirty;      // Bit n => part n
+  void _update_part_cache(int8_t part);
+  inline void _invalidate_part_cache(int8_t part = -1) {
+    _partCacheDirty |= (part >= 0 && part <= 15) ? 1 << part : 0xffff; }
+
+  // Reverb and chorus parameters are found in 0x0130 - 0x013f
+  std::atomic<uint32_t> _effectsGeneration;
+  inline void _invalidate_effects(int address = 0x0130, int size = 1) {
+    if (address < 0x0140 && address + size > 0x0130) _effectsGeneration++; }
+
+  // Writers are counted while modifying the parameter arrays, and the
+  // version is incremented after each write. Writes through the get_param_ptr()
+  // pointers are not detected.
+  std::atomic<uint32_t> _paramsWriters;
+  std::atomic<uint32_t> _paramsVersion;
+  inline void _begin_write(void) {
+    _paramsWriters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); }
+  inline void _end_write(void) {
+    _paramsVersion.fetch_add(1, std::memory_order_release);
+    _paramsWriters.fetch_sub(1, std::memory_order_release); }
+
   void _initialize_system_params(enum Mode = Mode::GS);
   void _initialize_patch_params(enum Mode = Mode::GS);
   void _initialize_drumSet_params();
@@ -175,6 +285,8 @@ private:
   // Temporary storage for pitchbend
   float _PBController[16];
 
+  static constexpr uint32_t _fileTag = 0x53435350;      // "PSCS"
+
   static constexpr std::array<uint8_t, 16> _convert_to_roland_part_id_LUT =
     { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 10, 11, 12, 13, 14, 15 };
   static constexpr std::array<uint8_t, 16> _convert_from_roland_part_id_LUT =
@@ -0,0 +1,123 @@
+/*
+ *  This file is part of libEmuSC, a Sound Canvas emulator library
+ *  Copyright (C) 2022-2026  Håkon Skjelten
+ *
+ *  libEmuSC is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libEmuSC is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libEmuSC. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Binary archive used for runtime state snapshots (see Synth::snapshot()).
+// Each stateful class implements a single serialize() method listing its
+// members through io(), which is used both for writing and reading the
+// snapshot. Only trivially copyable types are stored directly; data is
+// stored in native byte order and snapshots are not meant to be portable
+// between architectures or libEmuSC versions.
+
+
+#ifndef __STATE_ARCHIVE_H__
+#define __STATE_ARCHIVE_H__
+
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace EmuSC {
+
+
+class StateArchive
+{
+public:
+  // Create an empty archive for writing
+  StateArchive() : _loading(false), _pos(0) {}
+
+  // Create an archive for reading existing data
+  StateArchive(const std::vector<uint8_t> &data)
+    : _data(data), _loading(true), _pos(0) {}
+
+  inline bool loading(void) { return _loading; }
+  inline const std::vector<uint8_t> &data(void) { return _data; }
+
+  template <typename T>
+  void io(T &value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "StateArchive::io() requires trivially copyable types");
+    io_bytes(&value, sizeof(T));
+  }
+
+  void io(std::string &value)
+  {
+    uint32_t size = value.size();
+    io(size);
+    if (_loading) {
+      _check_size(size);
+      value.assign(reinterpret_cast<const char *>(&_data[_pos]), size);
+      _pos += size;
+    } else {
+      io_bytes(&value[0], size);
+    }
+  }
+
+  void io(std::vector<float> &value)
+  {
+    uint32_t size = value.size();
+    io(size);
+    if (_loading)
+      value.resize(size);
+    io_bytes(value.data(), size * sizeof(float));
+  }
+
+  void io_bytes(void *ptr, size_t size)
+  {
+    if (size == 0)
+      return;
+
+    if (_loading) {
+      _check_size(size);
+      std::memcpy(ptr, &_data[_pos], size);
+      _pos += size;
+    } else {
+      size_t pos = _data.size();
+      _data.resize(pos + size);
+      std::memcpy(&_data[pos], ptr, size);
+    }
+  }
+
+  // Section markers to catch inconsistent snapshots early
+  void tag(uint32_t id)
+  {
+    uint32_t value = id;
+    io(value);
+    if (value != id)
+      throw(std::string("Corrupt snapshot data (section mismatch)"));
+  }
+
+private:
+  std::vector<uint8_t> _data;
+  bool _loading;
+  size_t _pos;
+
+  void _check_size(size_t size)
+  {
+    if (_pos + size > _data.size())
+      throw(std::string("Corrupt snapshot data (unexpected end of data)"));
+  }
+};
+
+}
+
+#endif  // __STATE_ARCHIVE_H__
@@ -60,4 +60,14 @@ void SVF::clear()
   _bp = 0.0f;
 }
 
+
+void SVF::serialize(StateArchive &a)
+{
+  a.io(_mode);
+  a.io(_f);
+  a.io(_q);
+  a.io(_lp);
+  a.io(_bp);
+}
+
 }
@@ -25,6 +25,9 @@
 #define __SVF_H__
 
 
+#include "state_archive.h"
+
+
 namespace EmuSC {
 
 class SVF
@@ -51,6 +54,8 @@ public:
 
   void clear();
 
+  void serialize(StateArchive &a);
+
 private:
   Mode  _mode;     // Low-pass or high-pass
 
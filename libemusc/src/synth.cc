@@ -18,9 +18,13 @@
 
 
 #include "synth.h"
+#include "log.h"
 #include "part.h"
+#include "profiler.h"
 #include "settings.h"
+#include "state_archive.h"
 
+#include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <sys/stat.h>
@@ -29,9 +33,9 @@
 #include <fcntl.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <fstream>
-#include <iostream>
 #include <iomanip>
 
 #include "config.h"
@@ -39,35 +43,53 @@
 
 namespace EmuSC {
 
-Synth::Synth(ControlRom &controlRom, WaveRom &waveRom, SoundMap map)
+Synth::Synth(const ControlRom &controlRom, const WaveRom &waveRom, SoundMap map)
   : _sampleRate(0),
     _channels(0),
     _numClippedSamples(0),
+    _governorEnabled(false),
+    _governorBudget(0.8f),
+    _governorPolyphony(controlRom.max_polyphony()),
+    _governorShed(false),
+    _governorIdleBlocks(0),
+    _numShedVoices(0),
+    _numDeadlineMisses(0),
+    _pendingChannels(0),
+    _modifiedParts(0),
+    _coalescing(true),
+    _numCoalescedEvents(0),
+    _partMetersSeq(0),
     _ctrlRom(controlRom),
     _waveRom(waveRom),
     _phase(0.0),
     _updateCounter(0),
     _hostSampleBufRIndex(0),
-    _hostSampleBufWIndex(0)
+    _hostSampleBufWIndex(0),
+    _stemsEnabled(false),
+    _stemSends(false)
 {
-  srand (static_cast<unsigned>(time(0)));
-
   _settings = new Settings(controlRom);
+  _settings->set_random_seed(static_cast<uint64_t>(time(0)));
 
   _parts.reserve(16);
 
   if (map == SoundMap::GS) {
-    std::cout << "libEmuSC: GS sound map initialized" << std::endl;
+    LOG_INFO("GS sound map initialized");
   } else if (map == SoundMap::GS_GM) {
-    std::cout << "libEmuSC: GS (GM system) sound map initialized" << std::endl;
+    LOG_INFO("GS (GM system) sound map initialized");
     _settings->set_gm_mode();
   } else if (map == SoundMap::MT32) {
     _settings->set_map_mt32();
-    std::cout << "libEmuSC: MT-32 sound map initialized" << std::endl;
+    LOG_INFO("MT-32 sound map initialized");
   }
 
   _systemEffects = new SystemEffects(_settings);
   _resampler = new Resampler();
+
+  _profiler = new Profiler();
+#ifdef __EMUSC_PROFILER__
+  _settings->set_profiler(_profiler);
+#endif
 }
 
 
@@ -77,6 +99,7 @@ Synth::~Synth()
   delete _settings;
   delete _systemEffects;
   delete _resampler;
+  delete _profiler;
 }
 
 
@@ -89,6 +112,9 @@ void Synth::_init_parts(void)
 
 void Synth::reset(SoundMap sm, bool resetParts)
 {
+  // Also called from SysEx handling with midiMutex locked
+  _pendingChannels = 0;
+
   if (resetParts)
     for (auto &p : _parts) p.reset();   //? TODO: CLEAN UP
 
@@ -101,23 +127,108 @@ void Synth::reset(SoundMap sm, bool resetParts)
 }
 
 
+// Voice stealing order: released notes first (quietest first), then oldest
+static bool steal_before(const Part::StealCandidate &a,
+                         const Part::StealCandidate &b)
+{
+  if (a.released != b.released)
+    return a.released;
+
+  if (a.released && a.level != b.level)
+    return a.level < b.level;
+
+  return a.age > b.age;
+}
+
+
 void Synth::_add_note(uint8_t midiChannel, uint8_t key, uint8_t velocity)
+{
+  uint32_t parts = _settings->get_channel_parts(midiChannel);
+  for (int i = 0; parts; i++, parts >>= 1)
+    if ((parts & 1) && _parts[i].add_note(key, velocity))
+      _steal_partials(&_parts[i], _max_partials());
+}
+
+
+int Synth::_num_partials_used(void)
 {
   int partialsUsed = 0;
   for (auto &p: _parts)
     partialsUsed += p.get_num_partials();
 
-  // TODO: Prioritize parts / MIDI channels based on info in owners manual
-  // FIXME: Reduce voice count when volume envelope is corrected!
-  if (partialsUsed > _ctrlRom.max_polyphony() * 2)
-    std::cout << "EmuSC: New note on ignored due to voice limit"
-	      << std::endl;
-  else
-    for (auto &p: _parts)
-      if (p.midi_channel() == midiChannel)
-	p.add_note(key, velocity);
+  return partialsUsed;
+}
+
+
+int Synth::_max_partials(void)
+{
+  if (_governorEnabled.load(std::memory_order_relaxed))
+    return _governorPolyphony.load(std::memory_order_relaxed);
+
+  return _ctrlRom.max_polyphony();
+}
+
+
+// Steal voices until we are within maxPartials. Parts using more partials
+// than their partial reserve are the first candidates, and within these a
+// released (quietest first) or else the oldest note is chosen. A part within
+// its reserve only steals from itself if no other part is above its reserve.
+// If no voice can be stolen the new note is lost. newPart is NULL when the CPU
+// governor reduces polyphony, and reserves are then ignored as a last resort.
+// Returns number of partials freed.
+int Synth::_steal_partials(Part *newPart, int maxPartials)
+{
+  int partialsUsed = _num_partials_used();
+  int freedTotal = 0;
+
+  while (partialsUsed > maxPartials) {
+    Part *victim = _find_steal_victim(newPart, false);
+    if (victim == NULL && newPart == NULL)
+      victim = _find_steal_victim(newPart, true);
+
+    int freed = 0;
+    if (victim)
+      freed = victim->steal_note(victim == newPart);
+    else if (newPart)
+      freed = newPart->steal_note(true);
+
+    if (freed == 0) {
+      if (newPart)
+        freedTotal += newPart->delete_newest_note();
+      break;
+    }
+
+    partialsUsed -= freed;
+    freedTotal += freed;
+  }
+
+  return freedTotal;
+}
+
+
+Part *Synth::_find_steal_victim(Part *newPart, bool ignoreReserve)
+{
+  Part *victim = NULL;
+  Part::StealCandidate best;
+
+  for (auto &p : _parts) {
+    if (!ignoreReserve && p.get_num_partials() <= p.get_partial_reserve())
+      continue;
+
+    Part::StealCandidate c;
+    if (!p.get_steal_candidate(c, &p == newPart))
+      continue;
+
+    if (victim == NULL || steal_before(c, best)) {
+      victim = &p;
+      best = c;
+    }
+  }
+
+  return victim;
 }
 
+
 /* Not used -> WaveRom as part of sample dump to disk
 int Synth::_export_sample_24(std::vector<int32_t> &sampleSet,
 			     std::string filename)
@@ -171,68 +282,73 @@ void Synth::midi_input(uint8_t status, uint8_t data1, uint8_t data2)
 
   midiMutex.lock();
 
+  // Report parts modified by controllers applied in the audio thread
+  if (_modifiedParts)
+    _notify_modified_parts();
+
+  // Controller floods are reduced to one value per control block
+  if (_coalescing && _coalesce_controller(status, data1, data2)) {
+    midiMutex.unlock();
+    return;
+  }
+
+  if (_pendingChannels) {
+    _flush_controllers();
+    _notify_modified_parts();
+  }
+
+  // Run fn for all parts receiving on this MIDI channel
+  uint32_t parts = _settings->get_channel_parts(channel);
+  auto channelParts = [&](auto fn) {
+    for (uint32_t m = parts, i = 0; m; i++, m >>= 1)
+      if (m & 1) fn(_parts[i]);
+  };
+
   switch (status & 0xf0)
     {
     case midi_NoteOff:
-      for (auto &p: _parts)
-	if (p.midi_channel() == channel)
-	  p.stop_note(data1);
+      channelParts([&](Part &p) { p.stop_note(data1); });
       break;
 
     case midi_NoteOn:
-      if (!data2) {                   // Note On with velocity = 0 => Note Off
-	for (auto &p: _parts)
-	  if (p.midi_channel() == channel)
-	    p.stop_note(data1);
-      } else {
+      if (!data2)                     // Note On with velocity = 0 => Note Off
+	channelParts([&](Part &p) { p.stop_note(data1); });
+      else
 	_add_note(channel, data1, data2);
-      }
       break;
 
     case midi_PolyKeyPressure:
-      for (auto &p: _parts) {
-	if (p.midi_channel() == channel)
-	  p.poly_key_pressure(data1, data2);
-      }
+      channelParts([&](Part &p) { p.poly_key_pressure(data1, data2); });
       break;
 
     case midi_CtrlChange:
-      for (auto &p: _parts) {
-	if (p.midi_channel() == channel) {
-	  if (p.control_change(data1, data2)) {
-	    for (const auto &cb : _partMidiModCallbacks)
-	      cb(p.id());
-	  }
+      channelParts([&](Part &p) {
+	if (p.control_change(data1, data2)) {
+	  for (const auto &cb : _partMidiModCallbacks)
+	    cb(p.id());
 	}
-      }
+      });
       break;
 
     case midi_PrgChange:
-      for (auto &p : _parts)
-	if (p.midi_channel() == channel) {
-	  p.set_program(data1);
+      channelParts([&](Part &p) {
+	p.set_program(data1);
 
-	  for (const auto &cb : _partMidiModCallbacks)
-	    cb(p.id());
-	}
+	for (const auto &cb : _partMidiModCallbacks)
+	  cb(p.id());
+      });
       break;
 
     case midi_ChPressure:
-      for (auto &p: _parts) {
-	if (p.midi_channel() == channel)
-	  p.channel_pressure(data1);
-      }
+      channelParts([&](Part &p) { p.channel_pressure(data1); });
       break;
 
     case midi_PitchBend:
-      for (auto &p: _parts) {
-	if (p.midi_channel() == channel)
-	  p.pitch_bend_change(data1, data2);
-      }
+      channelParts([&](Part &p) { p.pitch_bend_change(data1, data2); });
       break;
 
     default:
-      std::cout << "EmuSC MIDI: Unknown event received" << std::endl;
+      LOG_WARNING("Unknown MIDI event received (status=0x%02x)", status);
       break;
     }
 
@@ -265,25 +381,32 @@ void Synth::midi_input_sysex(uint8_t *data, uint16_t length)
   while (checksum >= 128)
     checksum -= 128;
   if (data[length - 2] != 128 - checksum) {
-    std::cerr << "libEmuSC: Roland SysEx message received with corrupt "
-	      << "checksum. Message discarded." << std::endl;
+    LOG_WARNING("Roland SysEx message received with corrupt checksum. "
+		"Message discarded.");
     return;
   }
 
-  if (1) {
-    std::cout << "libEmuSC: Valid SysEx  message received: ";
-    for (int i = 0; i < length; i ++)
-      std::cout << std::hex << (int) data[i] << " " << std::flush;
-    std::cout << std::endl;
+  if (Log::enabled(Log::Level::Debug)) {
+    char hex[3 * 64 + 4] = "";
+    int n = std::min((int) length, 64);
+    for (int i = 0; i < n; i ++)
+      std::snprintf(&hex[3 * i], 4, "%02x ", data[i]);
+    LOG_DEBUG("Valid SysEx message received: %s%s", hex,
+	      (length > n) ? "..." : "");
   }
 
   if (data[4] == 0x11) {
-    std::cerr << "SysEx responses are not implemented yet" << std::endl;
+    LOG_WARNING("SysEx responses are not implemented yet");
     return;
   }
 
   midiMutex.lock();
 
+  if (_pendingChannels)
+    _flush_controllers();
+  if (_modifiedParts)
+    _notify_modified_parts();
+
   // Request data 1 (RQ1)
 //  if (data[4] == 0x11)
 //  _midi_input_sysex_RQ1(&data[5], length - 5 - 2); // Add reply data buffer
@@ -327,6 +450,88 @@ int Synth::get_next_frame(float &lOut, float &rOut)
 }
 
 
+int Synth::render_block(float *lOut, float *rOut, int frames,
+                        float **stemsL, float **stemsR)
+{
+  bool stems = _stemsEnabled && stemsL && stemsR;
+
+  // If samplerate is not set, just return silence
+  if (_sampleRate == 0) {
+    std::fill(lOut, lOut + frames, 0.0f);
+    std::fill(rOut, rOut + frames, 0.0f);
+    for (int s = 0; stems && s < numStems; s++) {
+      if (stemsL[s] && stemsR[s]) {
+        std::fill(stemsL[s], stemsL[s] + frames, 0.0f);
+        std::fill(stemsR[s], stemsR[s] + frames, 0.0f);
+      }
+    }
+    return 0;
+  }
+
+  int frame = 0;
+  while (frame < frames) {
+    if (_hostSampleBufWIndex == _hostSampleBufRIndex) {
+      _process_samples();
+      _hostSampleBufRIndex = 0;
+    }
+
+    int n = std::min(frames - frame,
+                     _hostSampleBufWIndex - _hostSampleBufRIndex);
+
+    uint32_t clipped = 0;
+    for (int i = 0; i < n; i++) {
+      float l = _hostSampleBufL[_hostSampleBufRIndex + i];
+      float r = _hostSampleBufR[_hostSampleBufRIndex + i];
+      if (l > 1.0f || l < -1.0f) clipped++;
+      if (r > 1.0f || r < -1.0f) clipped++;
+
+      lOut[frame + i] = std::clamp(l, -1.0f, 1.0f);
+      rOut[frame + i] = std::clamp(r, -1.0f, 1.0f);
+    }
+    if (clipped)
+      _numClippedSamples.fetch_add(clipped, std::memory_order_relaxed);
+
+    for (int s = 0; stems && s < numStems; s++) {
+      if (stemsL[s] && stemsR[s]) {
+        std::copy_n(&_stemBufL[s][_hostSampleBufRIndex], n, stemsL[s] + frame);
+        std::copy_n(&_stemBufR[s][_hostSampleBufRIndex], n, stemsR[s] + frame);
+      }
+    }
+
+    _hostSampleBufRIndex += n;
+    frame += n;
+  }
+
+  return frame;
+}
+
+
+int Synth::fast_forward(int frames)
+{
+  if (_sampleRate == 0 || frames <= 0)
+    return 0;
+
+  // Host samples already rendered are consumed first
+  int buffered = std::min(frames, _hostSampleBufWIndex - _hostSampleBufRIndex);
+  _hostSampleBufRIndex += buffered;
+  frames -= buffered;
+
+  // Follow render_block() block by block so that MIDI events sent between
+  // calls end up in the same control block as they would when rendering
+  int blocks = 0;
+  while (frames > 0) {
+    _skip_samples();
+    blocks++;
+
+    int n = std::min(frames, _hostSampleBufWIndex);
+    _hostSampleBufRIndex = n;
+    frames -= n;
+  }
+
+  return blocks;
+}
+
+
 uint32_t Synth::get_num_clipped_samples(bool reset)
 {
   if (reset)
@@ -336,64 +541,555 @@ uint32_t Synth::get_num_clipped_samples(bool reset)
 }
 
 
+void Synth::set_controller_coalescing(bool enable)
+{
+  midiMutex.lock();
+
+  if (!enable && _pendingChannels)
+    _flush_controllers();
+  _coalescing = enable;
+
+  midiMutex.unlock();
+}
+
+
+uint32_t Synth::get_num_coalesced_events(bool reset)
+{
+  if (reset)
+    return _numCoalescedEvents.exchange(0, std::memory_order_relaxed);
+
+  return _numCoalescedEvents.load(std::memory_order_relaxed);
+}
+
+
+// Store controller event as pending if it only sets a value. Events replacing
+// an already pending value are counted as coalesced.
+// Returns true if event was stored.
+bool Synth::_coalesce_controller(uint8_t status, uint8_t data1, uint8_t data2)
+{
+  PendingControllers &pc = _pendingControllers[status & 0x0f];
+  bool replaced = false;
+
+  switch (status & 0xf0)
+    {
+    case midi_CtrlChange: {
+      auto it = std::find(_coalescedCC.begin(), _coalescedCC.end(), data1);
+      if (it == _coalescedCC.end())
+	return false;
+
+      uint8_t bit = 1 << (it - _coalescedCC.begin());
+      replaced = pc.ccMask & bit;
+      pc.ccMask |= bit;
+      pc.cc[it - _coalescedCC.begin()] = data2;
+      break;
+    }
+
+    case midi_ChPressure:
+      replaced = pc.chPressure;
+      pc.chPressure = true;
+      pc.chPressureValue = data1;
+      break;
+
+    case midi_PitchBend:
+      replaced = pc.pitchBend;
+      pc.pitchBend = true;
+      pc.pitchBendLSB = data1;
+      pc.pitchBendMSB = data2;
+      break;
+
+    default:
+      return false;
+    }
+
+  _pendingChannels |= 1 << (status & 0x0f);
+  if (replaced)
+    _numCoalescedEvents.fetch_add(1, std::memory_order_relaxed);
+
+  return true;
+}
+
+
+// Apply all pending controller events. Must be called with midiMutex locked.
+// Parts with modified settings are only recorded in _modifiedParts since this
+// is also called from the audio thread, see _notify_modified_parts().
+void Synth::_flush_controllers(void)
+{
+  for (int ch = 0; ch < 16; ch++) {
+    if (!(_pendingChannels & (1 << ch)))
+      continue;
+
+    PendingControllers &pc = _pendingControllers[ch];
+    uint32_t parts = _settings->get_channel_parts(ch);
+
+    for (uint32_t m = parts, i = 0; m; i++, m >>= 1) {
+      if (!(m & 1))
+	continue;
+
+      Part &p = _parts[i];
+      for (int c = 0; c < (int) _coalescedCC.size(); c++) {
+	if ((pc.ccMask & (1 << c)) && p.control_change(_coalescedCC[c],
+						       pc.cc[c]))
+	  _modifiedParts |= 1 << i;
+      }
+
+      if (pc.chPressure)
+	p.channel_pressure(pc.chPressureValue);
+      if (pc.pitchBend)
+	p.pitch_bend_change(pc.pitchBendLSB, pc.pitchBendMSB);
+    }
+
+    pc.ccMask = 0;
+    pc.chPressure = false;
+    pc.pitchBend = false;
+  }
+
+  _pendingChannels = 0;
+}
+
+
+// Run part MIDI modification callbacks for parts modified by
+// _flush_controllers(). Must be called from the MIDI thread with midiMutex
+// locked.
+void Synth::_notify_modified_parts(void)
+{
+  uint16_t modified = _modifiedParts;
+  _modifiedParts = 0;
+
+  for (int i = 0; modified; i++, modified >>= 1)
+    if (modified & 1)
+      for (const auto &cb : _partMidiModCallbacks)
+	cb(_parts[i].id());
+}
+
+
 // Do a control update and read 256 samples
 void Synth::_process_samples(void)
 {
+  bool governor = _governorEnabled.load(std::memory_order_relaxed);
+  std::chrono::steady_clock::time_point blockStart;
+  if (governor)
+    blockStart = std::chrono::steady_clock::now();
+
+  PROFILE_BEGIN_BLOCK(_profiler);
+
+  midiMutex.lock();
+  if (_pendingChannels)
+    _flush_controllers();
+  midiMutex.unlock();
+
   // Start all samples processings with a control updates
-  for (auto &p : _parts)
-    p.update();
+  {
+    PROFILE_SCOPE(_profiler, PerfStage::PartsUpdate);
+    for (auto &p : _parts)
+      p.update();
+  }
 
   _systemEffects->update();
 
   // Clear all relative buffers before accumulating new samples
-  for (int i = 0; i < 2; i++) {
-    _dryBus[i].fill(0.0f);
-    _chorusBus[i].fill(0.0f);
-    _reverbBus[i].fill(0.0f);
+  {
+    PROFILE_SCOPE(_profiler, PerfStage::BusMix);
+    for (int i = 0; i < 2; i++) {
+      _dryBus[i].fill(0.0f);
+      _chorusBus[i].fill(0.0f);
+      _reverbBus[i].fill(0.0f);
+    }
+    std::fill(_hostSampleBufL.begin(), _hostSampleBufL.end(), 0.0f);
+    std::fill(_hostSampleBufR.begin(), _hostSampleBufR.end(), 0.0f);
   }
-  std::fill(_hostSampleBufL.begin(), _hostSampleBufL.end(), 0.0f);
-  std::fill(_hostSampleBufR.begin(), _hostSampleBufR.end(), 0.0f);
 
   midiMutex.lock();
 
   _hostSampleBufWIndex = 0;
 
+  // CPU governor exceeded its budget in last block => remove voices now
+  if (_governorShed) {
+    _governorShed = false;
+
+    int shed = 0;
+    for (auto &p : _parts)
+      shed += p.delete_inaudible_notes(_governorInaudibleLevel);
+    shed += _steal_partials(NULL, _governorPolyphony);
+
+    _numShedVoices.fetch_add(shed, std::memory_order_relaxed);
+  }
+
   // Iterate all parts and ask for next sample
   for (auto &p : _parts) {
     p.get_sample_set(_dryBus, _chorusBus, _reverbBus);
   }
+  _publish_part_meters();
 
   // Add system effects
   _systemEffects->apply(_chorusBus, _reverbBus, _chorusOut, _reverbOut);
 
   // Work through the dryBus and genereate samples adapted to host's sample rate
-  for (int i = 0; i < 256; i++) {
-
-    float l = _dryBus[0][i] + _chorusOut[0][i] + _reverbOut[0][i];
-    float r = _dryBus[1][i] + _chorusOut[1][i] + _reverbOut[1][i];
-    _resampler->push(l, r);
-
-    float hostL = 0, hostR = 0;
-    while (_resampler->get_next_sample(hostL, hostR)) {
-      if (_hostSampleBufWIndex < _hostSampleBufL.size()) {
-	_hostSampleBufL[_hostSampleBufWIndex] += hostL;
-	_hostSampleBufR[_hostSampleBufWIndex] += hostR;
-	_hostSampleBufWIndex++;
+  {
+    PROFILE_SCOPE(_profiler, PerfStage::Resampler);
+    for (int i = 0; i < 256; i++) {
+
+      float l = _dryBus[0][i] + _chorusOut[0][i] + _reverbOut[0][i];
+      float r = _dryBus[1][i] + _chorusOut[1][i] + _reverbOut[1][i];
+      _resampler->push(l, r);
+
+      float hostL = 0, hostR = 0;
+      while (_resampler->get_next_sample(hostL, hostR)) {
+	if (_hostSampleBufWIndex < _hostSampleBufL.size()) {
+	  _hostSampleBufL[_hostSampleBufWIndex] += hostL;
+	  _hostSampleBufR[_hostSampleBufWIndex] += hostR;
+	  _hostSampleBufWIndex++;
+	}
       }
     }
+
+    if (_stemsEnabled)
+      _render_stems();
   }
 
   midiMutex.unlock();
+
+  PROFILE_END_BLOCK(_profiler, _num_partials_used());
+
+  if (governor) {
+    std::chrono::duration<double> renderTime =
+      std::chrono::steady_clock::now() - blockStart;
+    _update_cpu_governor(renderTime.count());
+  }
+}
+
+
+// Control update without audio, see fast_forward()
+void Synth::_skip_samples(void)
+{
+  midiMutex.lock();
+  if (_pendingChannels)
+    _flush_controllers();
+  midiMutex.unlock();
+
+  for (auto &p : _parts)
+    p.update();
+
+  _systemEffects->update();
+  _systemEffects->skip_sample_set();
+
+  midiMutex.lock();
+
+  for (auto &p : _parts)
+    p.skip_sample_set();
+  _publish_part_meters();
+
+  // Keep the resamplers in step, leaving a block of silence in the host buffer
+  int n = std::min(_resampler->skip(256), (int) _hostSampleBufL.size());
+  std::fill_n(_hostSampleBufL.begin(), n, 0.0f);
+  std::fill_n(_hostSampleBufR.begin(), n, 0.0f);
+  for (int s = 0; _stemsEnabled && s < numStems; s++) {
+    _stemResamplers[s].skip(256);
+    std::fill_n(_stemBufL[s].begin(), n, 0.0f);
+    std::fill_n(_stemBufR[s].begin(), n, 0.0f);
+  }
+  _hostSampleBufRIndex = 0;
+  _hostSampleBufWIndex = n;
+
+  midiMutex.unlock();
+}
+
+
+// Resample each part's dry bus and the effect buses to host sample rate. All
+// resamplers have the same rate, so they produce the same number of samples as
+// the main mix.
+void Synth::_render_stems(void)
+{
+  for (int s = 0; s < numStems; s++) {
+    const std::array<std::array<float, 256>, 2> *bus = NULL;
+    if (s < static_cast<int>(Stem::ChorusReturn))
+      bus = (s < (int) _parts.size()) ? &_parts[s].get_part_bus() : NULL;
+    else if (s == static_cast<int>(Stem::ChorusReturn))
+      bus = &_chorusOut;
+    else if (s == static_cast<int>(Stem::ReverbReturn))
+      bus = &_reverbOut;
+    else if (_stemSends && s == static_cast<int>(Stem::ChorusSend))
+      bus = &_chorusBus;
+    else if (_stemSends && s == static_cast<int>(Stem::ReverbSend))
+      bus = &_reverbBus;
+
+    std::vector<float> &bufL = _stemBufL[s];
+    std::vector<float> &bufR = _stemBufR[s];
+    int w = 0;
+
+    if (bus) {
+      for (int i = 0; i < 256; i++) {
+        _stemResamplers[s].push((*bus)[0][i], (*bus)[1][i]);
+
+        float hostL = 0, hostR = 0;
+        while (_stemResamplers[s].get_next_sample(hostL, hostR)) {
+          if (w < _hostSampleBufWIndex) {
+            bufL[w] = hostL;
+            bufR[w] = hostR;
+            w++;
+          }
+        }
+      }
+    }
+
+    // Stems enabled while running may lag the main resampler by one sample
+    for (; w < _hostSampleBufWIndex; w++)
+      bufL[w] = bufR[w] = 0.0f;
+  }
+}
+
+
+void Synth::_init_stems(void)
+{
+  _stemResamplers.assign(numStems, Resampler());
+  for (auto &r : _stemResamplers)
+    r.set_sample_rate(_sampleRate);
+
+  _stemBufL.assign(numStems, std::vector<float>(_hostSampleBufL.size(), 0.0f));
+  _stemBufR.assign(numStems, std::vector<float>(_hostSampleBufR.size(), 0.0f));
+}
+
+
+void Synth::set_stem_output(bool enable, bool sends)
+{
+  midiMutex.lock();
+
+  _stemSends = sends;
+  if (enable && !_stemsEnabled && _sampleRate)
+    _init_stems();
+  _stemsEnabled = enable;
+
+  midiMutex.unlock();
+}
+
+
+// Lower effective polyphony quickly when the render time exceeds the budget,
+// and raise it slowly again when we are well within the budget
+void Synth::_update_cpu_governor(double renderTime)
+{
+  const double blockTime = 256 / 32000.0;
+  const double budget = blockTime * _governorBudget.load(std::memory_order_relaxed);
+  int polyphony = _governorPolyphony.load(std::memory_order_relaxed);
+
+  if (renderTime > blockTime)
+    _numDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+
+  if (renderTime > budget) {
+    _governorPolyphony.store(std::max(polyphony - 2, _governorMinPolyphony),
+                             std::memory_order_relaxed);
+    _governorShed = true;
+    _governorIdleBlocks = 0;
+
+  } else if (renderTime < budget / 2 && polyphony < _ctrlRom.max_polyphony()) {
+    if (++_governorIdleBlocks >= 32) {
+      _governorPolyphony.store(polyphony + 1, std::memory_order_relaxed);
+      _governorIdleBlocks = 0;
+    }
+
+  } else {
+    _governorIdleBlocks = 0;
+  }
+}
+
+
+void Synth::set_cpu_governor(bool enable, float budget)
+{
+  _governorBudget.store(std::clamp(budget, 0.1f, 1.0f),
+                        std::memory_order_relaxed);
+  _governorPolyphony.store(_ctrlRom.max_polyphony(),
+                           std::memory_order_relaxed);
+  _governorEnabled.store(enable, std::memory_order_relaxed);
+}
+
+
+void Synth::set_audibility_floor(float dBFS)
+{
+  if (std::isinf(dBFS) && dBFS < 0)
+    _settings->set_audibility_floor(0);
+  else
+    _settings->set_audibility_floor(std::pow(10.0f, dBFS / 20.0f));
+}
+
+
+float Synth::get_audibility_floor(void)
+{
+  float gain = _settings->audibility_floor();
+  if (gain <= 0)
+    return -INFINITY;
+
+  return 20 * std::log10(gain);
+}
+
+
+void Synth::set_random_seed(uint64_t seed)
+{
+  midiMutex.lock();
+  _settings->set_random_seed(seed);
+  midiMutex.unlock();
+}
+
+
+std::vector<uint8_t> Synth::snapshot(void)
+{
+  StateArchive a;
+
+  midiMutex.lock();
+  if (_pendingChannels)
+    _flush_controllers();
+  _serialize(a);
+  midiMutex.unlock();
+
+  return a.data();
+}
+
+
+void Synth::restore(const std::vector<uint8_t> &snapshot)
+{
+  StateArchive a(snapshot);
+  StateArchive backup;
+
+  midiMutex.lock();
+  _serialize(backup);
+
+  // Roll back to previous state if the snapshot turns out to be corrupt
+  try {
+    _serialize(a);
+  } catch (std::string errorMsg) {
+    StateArchive previous(backup.data());
+    _serialize(previous);
+    midiMutex.unlock();
+    throw(errorMsg);
+  }
+  _pendingChannels = 0;
+  midiMutex.unlock();
+}
+
+
+// Used for both snapshot and restore. A header identifying ROM and sample
+// rate is verified before any state is changed.
+void Synth::_serialize(StateArchive &a)
+{
+  a.tag(_snapshotMagic);
+  a.tag(_snapshotVersion);
+
+  std::string rom = _ctrlRom.model() + " " + _ctrlRom.version();
+  std::string snapshotRom = rom;
+  a.io(snapshotRom);
+  if (snapshotRom != rom)
+    throw(std::string("Snapshot was made with a different control ROM (") +
+          snapshotRom + ")");
+
+  uint32_t sampleRate = _sampleRate;
+  uint32_t numParts = _parts.size();
+  a.io(sampleRate);
+  a.io(numParts);
+  if (sampleRate != _sampleRate || numParts != _parts.size())
+    throw(std::string("Snapshot was made with a different audio format"));
+
+  _settings->serialize(a);
+
+  for (auto &p : _parts)
+    p.serialize(a);
+
+  // Restored after notes, as creating notes modifies portamento state and
+  // draws random numbers
+  a.io(_settings->portamento());
+  _settings->serialize_prng(a);
+
+  _systemEffects->serialize(a);
+  _resampler->serialize(a);
+
+  a.io(_hostSampleBufRIndex);
+  a.io(_hostSampleBufWIndex);
+  a.io(_hostSampleBufL);
+  a.io(_hostSampleBufR);
+
+  a.io(_stemsEnabled);
+  a.io(_stemSends);
+  if (_stemsEnabled) {
+    if (a.loading())
+      _init_stems();
+
+    for (int s = 0; s < numStems; s++) {
+      _stemResamplers[s].serialize(a);
+      a.io(_stemBufL[s]);
+      a.io(_stemBufR[s]);
+    }
+  }
+
+  a.tag(_snapshotMagic);
+}
+
+
+Synth::PerfStats Synth::get_perf_stats(bool reset)
+{
+  return _profiler->get_stats(reset);
+}
+
+
+int Synth::get_effective_polyphony(void)
+{
+  return _max_partials();
+}
+
+
+uint32_t Synth::get_num_shed_voices(bool reset)
+{
+  if (reset)
+    return _numShedVoices.exchange(0, std::memory_order_relaxed);
+
+  return _numShedVoices.load(std::memory_order_relaxed);
+}
+
+
+uint32_t Synth::get_num_deadline_misses(bool reset)
+{
+  if (reset)
+    return _numDeadlineMisses.exchange(0, std::memory_order_relaxed);
+
+  return _numDeadlineMisses.load(std::memory_order_relaxed);
+}
+
+
+// Called from audio thread after each control block. The buffer at
+// _partMetersSeq is left untouched for readers.
+void Synth::_publish_part_meters(void)
+{
+  uint32_t seq = _partMetersSeq.load(std::memory_order_relaxed);
+  std::array<PartMeter, 16> &meters = _partMeters[(seq + 1) & 1];
+
+  for (int i = 0; i < (int) _parts.size() && i < 16; i++)
+    meters[i] = _parts[i].get_meter();
+
+  _partMetersSeq.store(seq + 1, std::memory_order_release);
+}
+
+
+std::array<Synth::PartMeter, 16> Synth::get_part_meters(void)
+{
+  std::array<PartMeter, 16> meters;
+
+  // Retry in the unlikely case that the audio thread has published a new
+  // block and started overwriting the buffer while copying
+  for (;;) {
+    uint32_t seq = _partMetersSeq.load(std::memory_order_acquire);
+    meters = _partMeters[seq & 1];
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_partMetersSeq.load(std::memory_order_relaxed) == seq)
+      break;
+  }
+
+  return meters;
 }
 
 
 std::array<int, 16> Synth::get_parts_last_peak_sample(void)
 {
+  std::array<PartMeter, 16> meters = get_part_meters();
   std::array<int, 16> partVolumes;
 
-  int i = 0;
-  for (auto &p : _parts)
-    partVolumes[i++] = p.get_last_peak_sample();
+  for (int i = 0; i < 16; i++)
+    partVolumes[i] = meters[i].level;
 
   return partVolumes;
 }
@@ -412,6 +1108,9 @@ void Synth::set_audio_format(uint32_t sampleRate, uint8_t channels)
 
   _hostSampleBufL.resize(std::ceil(256 * sampleRate / 32000.0) + 1);
   _hostSampleBufR.resize(std::ceil(256 * sampleRate / 32000.0) + 1);
+
+  if (_stemsEnabled)
+    _init_stems();
 }
 
 
@@ -421,6 +1120,31 @@ std::string Synth::version(void)
 }
 
 
+void Synth::set_log_level(LogLevel level)
+{
+  Log::set_level(level);
+}
+
+
+Synth::LogLevel Synth::get_log_level(void)
+{
+  return Log::level();
+}
+
+
+void Synth::set_log_callback(std::function<void(LogLevel,
+                                                const std::string &)> cb)
+{
+  Log::set_callback(cb);
+}
+
+
+uint32_t Synth::get_num_dropped_log_messages(bool reset)
+{
+  return Log::get_num_dropped(reset);
+}
+
+
 void Synth::panic(void)
 {
   for (auto &p : _parts)
@@ -458,28 +1182,104 @@ void Synth::clear_part_change_callback()
 }
 
 
-void Synth::set_part_envelope_callback(int partId,
-                                       std::function<void(const float, const float, const float, const float, const float, const float)> callback)
+int Synth::get_part_telemetry(int partId, uint64_t &pos, PartTelemetry *data,
+                              int size)
+{
+  if (partId < 0 || partId >= (int) _parts.size())
+    return 0;
+
+  return _parts[partId].get_telemetry(pos, data, size);
+}
+
+
+bool Synth::get_param_snapshot(ParamSnapshot &snapshot)
+{
+  return _settings->snapshot_params(snapshot.version, snapshot.systemParams,
+                                    snapshot.patchParams, snapshot.drumParams);
+}
+
+
+// Parameters are stored in the same order as on the Sound Canvas (Roland part
+// IDs, big endian), see Settings for the original accessors
+uint8_t Synth::ParamSnapshot::get_param(enum SystemParam sp) const
+{
+  return systemParams[(int) sp];
+}
+
+
+const uint8_t* Synth::ParamSnapshot::get_param_ptr(enum SystemParam sp) const
+{
+  return &systemParams[(int) sp];
+}
+
+
+uint16_t Synth::ParamSnapshot::get_param_32nib(enum SystemParam sp) const
+{
+  const uint8_t *vPtr = &systemParams[(int) sp];
+
+  return (uint16_t) vPtr[3] | vPtr[2] << 4 | vPtr[1] << 8 | vPtr[0] << 12;
+}
+
+
+uint8_t Synth::ParamSnapshot::get_param(enum PatchParam pp, int8_t part) const
+{
+  return *get_param_ptr(pp, part);
+}
+
+
+const uint8_t* Synth::ParamSnapshot::get_param_ptr(enum PatchParam pp,
+                                                   int8_t part) const
+{
+  if (part < 0 || part > 15)
+    return &patchParams[(int) pp];
+
+  int8_t rolandPart = Settings::convert_to_roland_part_id(part);
+
+  return &patchParams[((int) pp | (rolandPart << 8))];
+}
+
+
+uint16_t Synth::ParamSnapshot::get_param_uint14(enum PatchParam pp,
+                                                int8_t part) const
+{
+  const uint8_t *ptr = get_param_ptr(pp, part);
+
+  return ((ptr[0] & 0x7f) << 7 | ptr[1]);
+}
+
+
+uint8_t Synth::ParamSnapshot::get_param_nib16(enum PatchParam pp,
+                                              int8_t part) const
 {
-  _parts[partId].set_envelope_callback(callback);
+  const uint8_t *ptr = get_param_ptr(pp, part);
+
+  return ((ptr[0] << 4) | (ptr[1] & 0x0f));
 }
 
-void Synth::clear_part_envelope_callback(int partId)
+
+uint8_t Synth::ParamSnapshot::get_patch_param(uint16_t address,
+                                              int8_t part) const
 {
-  _parts[partId].clear_envelope_callback();
+  if (part < 0 || part > 15)
+    return patchParams[address];
+
+  int8_t rolandPart = Settings::convert_to_roland_part_id(part);
+
+  return patchParams[(address | (rolandPart << 8))];
 }
 
 
-void Synth::set_part_lfo_callback(int partId,
-                                  std::function<void(const int, const int,
-                                                     const int)> callback)
+uint8_t Synth::ParamSnapshot::get_param(enum DrumParam dp, uint8_t map,
+                                        uint8_t key) const
 {
-  _parts[partId].set_lfo_callback(callback);
+  return drumParams[(int) dp | (map << 12) | key];
 }
 
-void Synth::clear_part_lfo_callback(int partId)
+
+const int8_t* Synth::ParamSnapshot::get_param_ptr(enum DrumParam dp,
+                                                  uint8_t map) const
 {
-  _parts[partId].clear_lfo_callback();
+  return (const int8_t *) &drumParams[(int) dp | (map << 12)];
 }
 
 
@@ -613,131 +1413,60 @@ void Synth::set_param(enum DrumParam dp, uint8_t map, uint8_t *data,
 }
 
 
-// TODO: Verify length when expexted data length is known!!
+// DT1 messages may contain any number of bytes as long as they stay within
+// one address block (last address byte 0x00 - 0x7f). Each message is written
+// to the parameter arrays in one operation, and the user interface is
+// notified once per message.
 void Synth::_midi_input_sysex_DT1(uint8_t model, uint8_t *data, uint16_t length)
 {
   if (length < 4)
     return;
 
-  int p = 0;
-  if (model == 0x42) {
-
-    // System parameters
-    if (data[0] == 0x40 && data[1] == 0x00) {
+  int size = length - 3;
+  uint16_t address = data[2] | (data[1] << 8);
 
-      // First handle the special case: Reset to the GSstandard mode message
-      if (data[2] == 0x7f) {
-	reset(SoundMap::GS, true);
-	return;
-      }
+  if (model == 0x42) {
 
-      uint8_t dataLength;             // Based on SysEx chart in Owner's Manual
-      if (data[2] == (int) SystemParam::Tune)
-	dataLength = 4;
-      else
-	dataLength = 1;
+    // First handle the special case: Reset to the GSstandard mode message
+    if (data[0] == 0x40 && data[1] == 0x00 && data[2] == 0x7f) {
+      reset(SoundMap::GS, true);
+      return;
+    }
 
-      if (length - dataLength != 3) {
-	std::cerr << "libemusc: Roland SysEx message has invalid data length! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
+    // Part parameters, Block 2/2 only has valid addresses up to 0x5a
+    int blockEnd = (data[0] == 0x40 && (data[1] & 0x20)) ? 0x5b : 0x80;
+    if (data[2] + size > blockEnd) {
+      LOG_WARNING("Roland SysEx message has invalid data length! "
+		  "Message discarded.");
+      return;
+    }
 
-      _settings->set_system_param(data[2], &data[3], dataLength);
+    // System parameters
+    if (data[0] == 0x40 && data[1] == 0x00) {
+      _settings->set_system_param(data[2], &data[3], size);
 
       for (const auto &cb : _partMidiModCallbacks)     // Update user interface
 	cb(-1);
 
     // Patch parameters part 1: Address space 40 01 XX
     } else if (data[0] == 0x40 && data[1] == 0x01) {
-
-      uint8_t dataLength = 1;          // Based on SysEx chart in Owner's Manual
-      if (data[2] == 0x00 || data[2] == 0x10)
-	dataLength = 0x10;
-
-      if (length - dataLength != 3) {
-	std::cerr << "libemusc: Roland SysEx message has invalid data length! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
-
-      uint16_t a = data[2] | (data[1] << 8);
-      _settings->set_patch_param(a, &data[3], dataLength);
+      _settings->set_patch_param(address, &data[3], size);
 
       for (const auto &cb : _partMidiModCallbacks)     // Update user interface
 	cb(-1);
 
-    // Patch parameters part 2: Address spcae 40 1P XX (P = Part)
-    } else if (data[0] == 0x40 && (data[1] & 0x10)) {
-
-      // Set length of message based on SysEx chart in Owner's Manual
-      uint8_t dataLength;
-      switch (data[2])
-	{
-	case 0x00:
-	case 0x17:
-	  dataLength = 2;
-	  break;
-	case 0x40:
-	  dataLength = 12;
-	  break;
-	default:
-	  dataLength = 1;
-	}
-
-      if (length - dataLength != 3) {
-	std::cerr << "libemusc: Roland SysEx message has invalid data length! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
-
-      uint16_t address = data[2] | (data[1] << 8);
-      _settings->set_patch_param(address, &data[3], dataLength);
+    // Patch parameters part 2: Address space 40 1P XX (P = Part) and
+    // part parameters, Block 2/2: Address 40 2P XX (P = Part)
+    } else if (data[0] == 0x40 && (data[1] & 0x30)) {
+      _settings->set_patch_param(address, &data[3], size);
 
       // Update user interface
       for (const auto &cb : _partMidiModCallbacks)
 	cb(Settings::convert_from_roland_part_id(data[1] & 0x0f));
 
-    // Part parameters, Block 2/2: Address 40 2P XX (P = Part)
-    } else if (data[0] == 0x40 && (data[1] & 0x20)) {
-
-      // All relevant messages has data length of 1 byte
-      if (length != 4) {
-	std::cerr << "libemusc: Roland SysEx message has invalid data length! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
-
-      // Verify that entire address is actually valid
-      if (data[2] > 0x5a) {
-	std::cerr << "libemusc: Roland SysEx message has invalid address! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
-
-      uint16_t address = data[2] | (data[1] << 8);
-      _settings->set_patch_param(address, &data[3], 1);
-
     // Drum parameters: Address 41 MX XX (M = Map)
     } else if (data[0] == 0x41 && !(data[1] & 0xe0)) {
-      // Set length of message based on SysEx chart in Owner's Manual
-      uint8_t dataLength;
-      switch (data[1] & 0x0f)
-	{
-	case 0x00:
-	  dataLength = 12;
-	  break;
-	default:
-	  dataLength = 1;
-	}
-
-      if (length - dataLength != 3) {
-	std::cerr << "libemusc: Roland SysEx message has invalid data length! "
-		  << "Message discarded." << std::endl;
-	return;
-      }
-
-      _settings->set_drum_param(data[2] | data[1] << 8, &data[3], dataLength);
+      _settings->set_drum_param(address, &data[3], size);
     }
   }
 }
@@ -57,7 +57,9 @@
 namespace EmuSC {
 
 class Part;
+class Profiler;
 class Settings;
+class StateArchive;
 
 class Synth
 {
@@ -69,7 +71,65 @@ public:
     MT32                      // MT32 arrangement
   };
 
-  Synth(ControlRom &cRom, WaveRom &pRom, SoundMap map = SoundMap::GS);
+  // Render stages measured by the profiler (see get_perf_stats())
+  enum class PerfStage {
+    PartsUpdate = 0,          // Control updates for all parts
+    Oscillator  = 1,          // Wave oscillators
+    TVF         = 2,
+    TVA         = 3,
+    BusMix      = 4,          // Clearing buses and part send levels
+    Chorus      = 5,
+    Reverb      = 6,
+    Resampler   = 7,          // Final mix and resampling to host rate
+    Total       = 8           // Complete control block
+  };
+
+  struct PerfStageStats {
+    double min;               // All values are microseconds per block
+    double avg;
+    double p99;               // Calculated from the last 1024 blocks
+    double max;
+  };
+
+  struct PerfStats {
+    bool enabled;             // False if libEmuSC is built without profiler
+    uint64_t blocks;          // Number of control blocks measured
+    std::array<PerfStageStats, 9> stages;
+    int activeVoices;         // Active partials in last block
+    int maxActiveVoices;
+    double dspLoad;           // Average block time / block duration
+    double xrunRiskRatio;     // Ratio of blocks using > 80% of block duration
+  };
+
+  // Stem buffers available from render_block() when stem output is enabled.
+  // Part stems are at index Part + part id [0-15].
+  enum class Stem {
+    Part         = 0,         // Dry output per part, pre system effects
+    ChorusReturn = 16,
+    ReverbReturn = 17,
+    ChorusSend   = 18,        // Sum of all part chorus sends (optional)
+    ReverbSend   = 19         // Sum of all part reverb sends (optional)
+  };
+  static constexpr int numStems = 20;
+
+  struct PartTelemetry {
+    bool active;              // False if part has no active notes
+    float pitch[2];           // Envelopes for partial 1 & 2
+    float tvf[2];
+    float tva[2];
+    int lfo[3];               // LFO1, LFO2 partial 1, LFO2 partial 2
+  };
+
+  enum class LogLevel {
+    Off     = 0,
+    Error   = 1,
+    Warning = 2,
+    Info    = 3,              // Default
+    Debug   = 4               // Includes all received SysEx messages
+  };
+
+  Synth(const ControlRom &cRom, const WaveRom &pRom,
+        SoundMap map = SoundMap::GS);
   ~Synth();
 
   // Add start() and stop()? Won't start if sampleRate is not set?
@@ -78,7 +138,83 @@ public:
   void midi_input_sysex(uint8_t *data, uint16_t length);
 
   int get_next_frame(float &lOut, float &rOut);
+
+  // Render a block of frames, same as calling get_next_frame() for each
+  // frame. If stem output is enabled and stemsL / stemsR are given, each of
+  // the numStems stems is written to stemsL[stem] / stemsR[stem] as well.
+  // Stems with NULL buffers are skipped. Stems are not clamped to [-1, 1].
+  // Returns number of frames rendered.
+  int render_block(float *lOut, float *rOut, int frames,
+                   float **stemsL = NULL, float **stemsR = NULL);
+
+  // Advance time by a number of host frames without generating audio. MIDI
+  // events sent before this call are applied as usual, but only control rate
+  // state (envelopes, LFOs, sample positions and note lifetimes) is updated.
+  // Oscillators, filters and reverb are not run and the resamplers are fed
+  // silence. Used for quickly chasing controllers and voices when seeking in a
+  // MIDI file.
+  // Returns number of control blocks (256 samples @ 32 kHz) processed.
+  int fast_forward(int frames);
+
+  // Enable rendering of stems (see Stem) in a single pass. Each stem is
+  // resampled to host sample rate separately, so this adds considerable CPU
+  // load. Set before starting audio output.
+  void set_stem_output(bool enable, bool sends = false);
+  bool get_stem_output(void) { return _stemsEnabled; }
   uint32_t get_num_clipped_samples(bool reset = true);
+
+  // Controller events (pitch bend, channel pressure and CC 1, 5, 7, 10, 11,
+  // 91 and 93) are held back until the next control block, and only the last
+  // value per MIDI channel and controller is applied. All other MIDI events
+  // apply held back events first, so the result is the same as applying each
+  // event immediately. Enabled by default. Note that part MIDI mod callbacks
+  // for held back events are deferred to the next midi_input() or
+  // midi_input_sysex() call, and are thus always called from the MIDI thread.
+  void set_controller_coalescing(bool enable);
+  uint32_t get_num_coalesced_events(bool reset = true);
+
+  // Optional CPU budget governor. When enabled, the time spent rendering each
+  // control block (256 samples @ 32 kHz = 8 ms) is measured against budget,
+  // given as a fraction of the block duration. When the budget is exceeded
+  // the effective polyphony is lowered and silent released voices are removed.
+  void set_cpu_governor(bool enable, float budget = 0.8f);
+  int get_effective_polyphony(void);
+
+  // Released voices with an output level below this floor (in dBFS, after
+  // part level and expression scaling) are terminated early. Default is -96
+  // dBFS. Use -INFINITY to disable.
+  void set_audibility_floor(float dBFS);
+  float get_audibility_floor(void);
+
+  // Seed the random generators used for random pitch, random panpot and random
+  // LFO waveforms. Seeded from the current time by default; set a fixed seed
+  // before rendering to get bit-reproducible output.
+  void set_random_seed(uint64_t seed);
+
+  // Serialize the complete runtime state (parameters, active voices with
+  // envelopes and LFOs, effect buffers and resampler history) to a binary
+  // blob. Restoring it makes the synth continue exactly from that point.
+  // Snapshots are only valid for the same ROM set, sample rate and libEmuSC
+  // version. restore() throws std::string on invalid snapshots and leaves
+  // the current state untouched.
+  std::vector<uint8_t> snapshot(void);
+  void restore(const std::vector<uint8_t> &snapshot);
+
+  // Per-stage render statistics. Requires libEmuSC to be built with the
+  // emusc_WITH_PROFILER CMake option, otherwise enabled is false.
+  PerfStats get_perf_stats(bool reset = false);
+  uint32_t get_num_shed_voices(bool reset = true);
+  uint32_t get_num_deadline_misses(bool reset = true);
+
+  // Levels for all parts, published after every control block. Lock-free and
+  // never blocks the audio thread.
+  struct PartMeter {
+    int level;                // Bar display level [0-16], -1 => muted
+    float peak;               // Highest sample value in last block
+    float rms;                // RMS of last block, both channels
+    int tvaMax;               // Highest TVA envelope level of active notes
+  };
+  std::array<PartMeter, 16> get_part_meters(void);
   std::array<int, 16> get_parts_last_peak_sample(void);
 
   // Setting audio properties (default is 44100, 2)
@@ -91,6 +227,16 @@ public:
   // Returns libEmuSC version as a string
   static std::string version(void);
 
+  // Log messages from all libEmuSC instances are written to stdout / stderr
+  // by a background thread, or passed to callback (from the same thread) if
+  // set. Logging never blocks the audio or MIDI threads; messages are dropped
+  // instead if the log thread falls behind.
+  static void set_log_level(LogLevel level);
+  static LogLevel get_log_level(void);
+  static void set_log_callback(std::function<void(LogLevel,
+                                                  const std::string &)> cb);
+  static uint32_t get_num_dropped_log_messages(bool reset = true);
+
   void set_part_instrument(uint8_t partId, uint8_t index, uint8_t bank);
 
   void add_part_midi_mod_callback(std::function<void(const int)> callback);
@@ -99,15 +245,39 @@ public:
   void add_part_change_callback(std::function<void(const int)> callback);
   void clear_part_change_callback(void);
 
-  void set_part_envelope_callback(int partId,
-                                  std::function<void(const float, const float,
-                                                     const float, const float,
-                                                     const float, const float)> callback);
-  void clear_part_envelope_callback(int partId);
-  void set_part_lfo_callback(int partId,
-                             std::function<void(const int, const int, const int)
-                             > callback);
-  void clear_part_lfo_callback(int partId);
+  // Envelope and LFO values of the first active note in a part are recorded
+  // once per control block (256 samples @ 32 kHz = 8 ms) for frontend scopes.
+  // Copies up to size entries recorded since position pos, oldest first, and
+  // advances pos. Only the last 256 entries are kept. Lock-free and never
+  // blocks the audio thread; each reader keeps its own pos (start with 0).
+  int get_part_telemetry(int partId, uint64_t &pos, PartTelemetry *data,
+                         int size);
+
+  // Consistent copy of all system, patch and drum parameters. Accessors
+  // mirror the get_param() methods below.
+  struct ParamSnapshot {
+    uint32_t version = 0;             // 0 => no parameters copied yet
+    std::array<uint8_t, 0x0100> systemParams{};
+    std::array<uint8_t, 0x4000> patchParams{};
+    std::array<uint8_t, 0x2000> drumParams{};
+
+    uint8_t  get_param(enum SystemParam sp) const;
+    const uint8_t* get_param_ptr(enum SystemParam sp) const;
+    uint16_t get_param_32nib(enum SystemParam sp) const;
+    uint8_t  get_param(enum PatchParam pp, int8_t part = -1) const;
+    const uint8_t* get_param_ptr(enum PatchParam pp, int8_t part = -1) const;
+    uint16_t get_param_uint14(enum PatchParam pp, int8_t part = -1) const;
+    uint8_t  get_param_nib16(enum PatchParam pp, int8_t part = -1) const;
+    uint8_t  get_patch_param(uint16_t address, int8_t part = -1) const;
+    uint8_t  get_param(enum DrumParam dp, uint8_t map, uint8_t key) const;
+    const int8_t* get_param_ptr(enum DrumParam dp, uint8_t map) const;
+  };
+
+  // Updates snapshot if any parameter has changed since it was taken, and
+  // returns false otherwise. Never blocks MIDI or audio threads, and is cheap
+  // enough to call on every frontend refresh. Unlike get_param_ptr(), the
+  // snapshot is never modified while being read.
+  bool get_param_snapshot(ParamSnapshot &snapshot);
 
   // EmuSC clients methods for getting synth paramters
   uint8_t  get_param(enum SystemParam sp);
@@ -145,14 +315,44 @@ private:
 
   std::atomic<uint32_t> _numClippedSamples;
 
+  // CPU budget governor
+  std::atomic<bool> _governorEnabled;
+  std::atomic<float> _governorBudget;     // Fraction of block duration
+  std::atomic<int> _governorPolyphony;    // Effective polyphony (partials)
+  bool _governorShed;                     // Shed voices in next block
+  int _governorIdleBlocks;                // Blocks well within budget
+  std::atomic<uint32_t> _numShedVoices;   // Partials removed by governor
+  std::atomic<uint32_t> _numDeadlineMisses;
+
   std::mutex midiMutex;
 
+  // Controller events waiting for next control block, see
+  // set_controller_coalescing(). Protected by midiMutex.
+  struct PendingControllers {
+    uint8_t ccMask;                  // Bit n => _coalescedCC[n] is pending
+    std::array<uint8_t, 7> cc;
+    bool pitchBend;
+    uint8_t pitchBendLSB;
+    uint8_t pitchBendMSB;
+    bool chPressure;
+    uint8_t chPressureValue;
+  };
+  std::array<PendingControllers, 16> _pendingControllers{};
+  uint16_t _pendingChannels;         // Bit n => MIDI channel n
+  uint16_t _modifiedParts;           // Bit n => part n, callbacks pending
+  bool _coalescing;
+  std::atomic<uint32_t> _numCoalescedEvents;
+
+  // Part meters are written to the buffer not being read, see get_part_meters()
+  std::array<std::array<PartMeter, 16>, 2> _partMeters{};
+  std::atomic<uint32_t> _partMetersSeq;
+
   struct std::vector<Part> _parts;
   std::vector<std::function<void(const int)>> _partMidiModCallbacks;
   std::vector<std::function<void(const int)>> _partChangeCallbacks;
 
-  ControlRom &_ctrlRom;
-  WaveRom &_waveRom;
+  const ControlRom &_ctrlRom;
+  const WaveRom &_waveRom;
 
   float _phase;               // Fractional SC-55 sample position
   float _phaseIncrement;      // SC-55 samples per host sample
@@ -163,6 +363,7 @@ private:
   int _hostSampleBufRIndex;
   int _hostSampleBufWIndex;
 
+
   std::array<std::array<float, 256>, 2> _dryBus;
   std::array<std::array<float, 256>, 2> _chorusBus;
   std::array<std::array<float, 256>, 2> _reverbBus;
@@ -170,9 +371,18 @@ private:
   std::array<std::array<float, 256>, 2> _chorusOut;
   std::array<std::array<float, 256>, 2> _reverbOut;
 
+  // Stem output
+  bool _stemsEnabled;
+  bool _stemSends;
+  std::vector<Resampler> _stemResamplers;
+  std::vector<std::vector<float>> _stemBufL;
+  std::vector<std::vector<float>> _stemBufR;
+
   SystemEffects *_systemEffects;
   Resampler *_resampler;
 
+  Profiler *_profiler;
+
   // MIDI message types
   static const uint8_t midi_NoteOff         = 0x80;
   static const uint8_t midi_NoteOn          = 0x90;
@@ -186,9 +396,34 @@ private:
 // int _export_sample_24(std::vector<int32_t> &sampleSet, std::string filename);
   void _add_note(uint8_t midiChannel, uint8_t key, uint8_t velocity);
 
+  int _num_partials_used(void);
+  int _max_partials(void);
+  int _steal_partials(Part *newPart, int maxPartials);
+  Part *_find_steal_victim(Part *newPart, bool ignoreReserve);
+
+  void _update_cpu_governor(double renderTime);
+  void _skip_samples(void);
+  void _publish_part_meters(void);
+
+  bool _coalesce_controller(uint8_t status, uint8_t data1, uint8_t data2);
+  void _flush_controllers(void);
+  void _notify_modified_parts(void);
+
+  static constexpr uint32_t _snapshotMagic = 0x43534d45;   // "EMSC"
+  static constexpr uint32_t _snapshotVersion = 2;
+
+  static constexpr std::array<uint8_t, 7> _coalescedCC =
+    { 1, 5, 7, 10, 11, 91, 93 };
+
+  static constexpr int _governorMinPolyphony = 8;
+  static constexpr int _governorInaudibleLevel = 0x04;    // TVA envelope level
+
   void _midi_input_sysex_DT1(uint8_t model, uint8_t *data, uint16_t length);
 
   void _process_samples(void);
+  void _serialize(StateArchive &a);
+  void _init_stems(void);
+  void _render_stems(void);
 
   Synth();
 };
@@ -25,6 +25,7 @@
 
 
 #include "system_effects.h"
+#include "profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -36,7 +37,8 @@ namespace EmuSC {
 SystemEffects::SystemEffects(Settings *settings)
   : _settings(settings),
     _chorus(NULL),
-    _reverb(NULL)
+    _reverb(NULL),
+    _generation(0)
 {
   _chorus = new Chorus(settings);
   _reverb = new Reverb(settings);
@@ -58,22 +60,32 @@ int SystemEffects::apply(std::array<std::array<float, 256>, 2> &chorusBus,
 			 std::array<std::array<float, 256>, 2> &chorusOut,
 			 std::array<std::array<float, 256>, 2> &reverbOut)
 {
-  float cReverbSend;
-
-  for (int i = 0; i < 256; i ++) {
-    float cSample[2] = { 0, 0 };
-    float cInput = 0.5f * (chorusBus[0][i] + chorusBus[1][i]);
-    _chorus->process_sample(cInput, cSample, &cReverbSend);
-
-    chorusOut[0][i] = cSample[0];
-    chorusOut[1][i] = cSample[1];
+  // Chorus output sent to reverb. Chorus is processed for the complete block
+  // first, since it does not depend on reverb output.
+  std::array<float, 256> cReverbSend;
+
+  {
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::Chorus);
+    for (int i = 0; i < 256; i ++) {
+      float cSample[2] = { 0, 0 };
+      float cInput = 0.5f * (chorusBus[0][i] + chorusBus[1][i]);
+      _chorus->process_sample(cInput, cSample, &cReverbSend[i]);
+
+      chorusOut[0][i] = cSample[0];
+      chorusOut[1][i] = cSample[1];
+    }
+  }
 
-    float rSample[2] = { 0, 0 };
-    float rInput = 0.5f * (reverbBus[0][i] + reverbBus[1][i]) + cReverbSend;
-    _reverb->process_sample(rInput, rSample);
+  {
+    PROFILE_SCOPE(_settings->profiler(), Synth::PerfStage::Reverb);
+    for (int i = 0; i < 256; i ++) {
+      float rSample[2] = { 0, 0 };
+      float rInput = 0.5f * (reverbBus[0][i] + reverbBus[1][i]) + cReverbSend[i];
+      _reverb->process_sample(rInput, rSample);
 
-    reverbOut[0][i] = rSample[0];
-    reverbOut[1][i] = rSample[1];
+      reverbOut[0][i] = rSample[0];
+      reverbOut[1][i] = rSample[1];
+    }
   }
 
   return 0;
@@ -82,8 +94,27 @@ int SystemEffects::apply(std::array<std::array<float, 256>, 2> &chorusBus,
 
 void SystemEffects::update(void)
 {
+  // Any number of parameter changes since last block results in one update
+  uint32_t generation = _settings->effects_generation();
+  if (generation == _generation)
+    return;
+
+  _generation = generation;
   _chorus->update();
   _reverb->update();
 }
 
+
+void SystemEffects::skip_sample_set(void)
+{
+  _chorus->skip_samples(256);
+}
+
+
+void SystemEffects::serialize(StateArchive &a)
+{
+  _chorus->serialize(a);
+  _reverb->serialize(a);
+}
+
 } //  namespace EmuSC
@@ -41,7 +41,12 @@ public:
 	    std::array<std::array<float, 256>, 2> &reverbBus,
 	    std::array<std::array<float, 256>, 2> &chorusOut,
 	    std::array<std::array<float, 256>, 2> &reverbOut);
-  void update(void);
+  void update(void);              // No-op unless effect parameters changed
+
+  // Advance modulation state by 256 samples without processing any audio
+  void skip_sample_set(void);
+
+  void serialize(StateArchive &a);
 
 private:
   Settings *_settings;
@@ -49,6 +54,8 @@ private:
   Chorus *_chorus;
   Reverb *_reverb;
 
+  uint32_t _generation;          // Settings effects generation last applied
+
   SystemEffects();
 };
 
@@ -33,6 +33,7 @@
 
 
 #include "tva.h"
+#include "log.h"
 
 #include <algorithm>
 #include <cmath>
@@ -44,22 +45,23 @@
 namespace EmuSC {
 
 
-TVA::TVA(ControlRom &ctrlRom, uint8_t key, uint8_t velocity, int sampleIndex,
-         WaveGenerator *LFO1, WaveGenerator *LFO2, Settings *settings,
-         int8_t partId, uint16_t instrumentIndex, int partialId)
+TVA::TVA(const ControlRom &ctrlRom, uint8_t key, uint8_t velocity,
+         int sampleIndex, WaveGenerator *LFO1, WaveGenerator *LFO2,
+         Settings *settings, int8_t partId, uint16_t instrumentIndex,
+         int partialId)
   : Envelope(ctrlRom.lookupTables),
+    _prevDynLevel(0),
+    _envLevel(0),
     _LFO1(LFO1),
     _LFO2(LFO2),
     _lfo1FadeComplete(false),
     _lfo2FadeComplete(false),
     _LUT(ctrlRom.lookupTables),
-    _prevDynLevel(0),
-    _envLevel(0),
+    _instPartial(ctrlRom.instrument(instrumentIndex).partials[partialId]),
     _key(key),
     _drumSet(settings->get_param(PatchParam::UseForRhythm, partId)),
     _panpot(-1),
     _panpotLocked(false),
-    _instPartial(ctrlRom.instrument(instrumentIndex).partials[partialId]),
     _settings(settings),
     _partId(partId)
 {
@@ -71,7 +73,7 @@ TVA::TVA(ControlRom &ctrlRom, uint8_t key, uint8_t velocity, int sampleIndex,
   if (settings->get_param(PatchParam::PartPanpot, _partId) == 0 ||
       (_drumSet &&
        settings->get_param(DrumParam::Panpot, _drumSet - 1, _key) == 0)) {
-    _panpot = std::rand() % 128;
+    _panpot = settings->note_prng().next() % 128;
     _panpotL = _LUT.TVAPanpot[_panpot];
     _panpotR = _LUT.TVAPanpot[0x80 - _panpot];
     _panpotLocked = true;
@@ -182,8 +184,8 @@ void TVA::_update_dynamic_level()
   _prevDynLevel = _dynLevel;
 
   // 1: Read expression, Part level and System level
-  _dynLevel = _settings->get_param(PatchParam::Expression, _partId) *
-    _settings->get_param(PatchParam::PartLevel, _partId) *
+  const Settings::PartCache &pc = _settings->part_cache(_partId);
+  _dynLevel = pc.expression * pc.partLevel *
     _settings->get_param(SystemParam::Volume);
   _dynLevel = (((4 * _dynLevel) >> 8) & 0xffff);
 
@@ -239,7 +241,7 @@ void TVA::_update_panpot_level(bool reset)
     return;
 
   int newPanpot = _instPartial.panpot +
-    _settings->get_param(PatchParam::PartPanpot, _partId) +
+    _settings->part_cache(_partId).panpot +
     _settings->get_param(SystemParam::Pan) - 0x80;
 
   if (_drumSet)
@@ -270,8 +272,7 @@ void TVA::_iterate_phase(void)
   _prevEnvLevel = _envLevel;
 
   if (_phase == Phase::Terminated) {
-    std::cerr << "libEmuSC: Internal error, envelope used in Terminated phase"
-	      << std::endl;
+    LOG_ERROR("Internal error, envelope used in Terminated phase");
     return;
 
   } else if (_phase == Phase::Sustain) {
@@ -452,8 +453,7 @@ int TVA::_get_velocity_from_vcurve(uint8_t velocity)
 {
   unsigned int address = _instPartial.TVALvlVelCur * 128 + velocity;
   if (address > _LUT.VelocityCurves.size()) {
-    std::cerr << "libEmuSC internal error: Illegal velocity curve used"
-              << std::endl;
+    LOG_ERROR("Internal error, illegal velocity curve used");
     return 0;
   }
 
@@ -461,7 +461,7 @@ int TVA::_get_velocity_from_vcurve(uint8_t velocity)
 }
 
 
-void TVA::_init_envelope(ControlRom &ctrlRom, int sampleIndex,
+void TVA::_init_envelope(const ControlRom &ctrlRom, int sampleIndex,
                          int instrumentIndex, uint8_t cVelocity)
 {
   // First step is to calculate correct initial phase levels
@@ -627,4 +627,27 @@ void TVA::_smooth(int mode, float start, float target,
   gain[255] = target;
 }
 
+
+void TVA::serialize(StateArchive &a)
+{
+  _serialize_envelope(a);
+
+  a.io(_dynLevel);
+  a.io(_dynLevelMode);
+  a.io(_prevDynLevel);
+  a.io(_envLevel);
+  a.io(_envLevelMode);
+  a.io(_prevEnvLevel);
+  a.io(_lfo1FadeComplete);
+  a.io(_lfo2FadeComplete);
+  a.io(_lfo1Depth);
+  a.io(_lfo2Depth);
+  a.io(_key);
+  a.io(_drumSet);
+  a.io(_panpot);
+  a.io(_panpotL);
+  a.io(_panpotR);
+  a.io(_panpotLocked);
+}
+
 }
@@ -36,9 +36,10 @@ namespace EmuSC {
 class TVA : public Envelope
 {
 public:
-  TVA(ControlRom &ctrlRom, uint8_t key, uint8_t velocity, int sampleIndex,
-      WaveGenerator *LFO1, WaveGenerator *LFO2, Settings *settings,
-      int8_t partId, uint16_t instrumentIndex, int partialId);
+  TVA(const ControlRom &ctrlRom, uint8_t key, uint8_t velocity,
+      int sampleIndex, WaveGenerator *LFO1, WaveGenerator *LFO2,
+      Settings *settings, int8_t partId, uint16_t instrumentIndex,
+      int partialId);
 
   void update(bool reset = false);
   void apply(double *sample);
@@ -46,6 +47,12 @@ public:
 
   void note_off();
 
+  void serialize(StateArchive &a);
+
+  // Current linear gain from dynamic level (part level, expression etc.) and
+  // envelope level combined, using the same scaling as apply_sample_set()
+  float gain(void) { return (_dynLevel / 32768.0f) * (_envLevel / 32768.0f); }
+
 private:
   int _dynLevel;
   int _dynLevelMode;
@@ -63,8 +70,8 @@ private:
   int _lfo1Depth;
   int _lfo2Depth;
 
-  ControlRom::LookupTables &_LUT;
-  ControlRom::InstPartial &_instPartial;
+  const ControlRom::LookupTables &_LUT;
+  const ControlRom::InstPartial &_instPartial;
 
   uint8_t _key;
   int _drumSet;
@@ -79,8 +86,8 @@ private:
 
   TVA();
 
-  void _init_envelope(ControlRom &ctrlRom, int sampleIndex, int instrumentIndex,
-                      uint8_t cVelocity);
+  void _init_envelope(const ControlRom &ctrlRom, int sampleIndex,
+                      int instrumentIndex, uint8_t cVelocity);
 
   void _update_dynamic_level(void);
   void _update_panpot_level(bool reset);
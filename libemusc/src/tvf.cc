@@ -41,6 +41,7 @@
 
 
 #include "tvf.h"
+#include "log.h"
 
 #include <algorithm>
 #include <cmath>
@@ -51,9 +52,10 @@
 namespace EmuSC {
 
 
-TVF::TVF(ControlRom::InstPartial &instPartial, uint8_t key, uint8_t velocity,
-         WaveGenerator *LFO1, WaveGenerator *LFO2,ControlRom::LookupTables &LUT,
-         Settings *settings, int8_t partId)
+TVF::TVF(const ControlRom::InstPartial &instPartial, uint8_t key,
+         uint8_t velocity, WaveGenerator *LFO1, WaveGenerator *LFO2,
+         const ControlRom::LookupTables &LUT, Settings *settings,
+         int8_t partId)
   : Envelope(LUT),
     _sampleRate(settings->sample_rate()),
     _LFO1(LFO1),
@@ -224,8 +226,7 @@ int TVF::_get_velocity_from_vcurve(uint8_t velocity)
 {
   unsigned int address = _instPartial.TVFCOFVelCur * 128 + velocity;
   if (address > _LUT.VelocityCurves.size()) {
-    std::cerr << "libEmuSC internal error: Illegal velocity curve used"
-              << std::endl;
+    LOG_ERROR("Internal error, illegal velocity curve used");
     return 0;
   }
 
@@ -532,8 +533,7 @@ void TVF::_iterate_phase(void)
 void TVF::_init_new_phase(enum Phase newPhase)
 {
   if (newPhase == Phase::Terminated) {
-    std::cerr << "libEmuSC: Internal error, envelope in illegal state"
-	      << std::endl;
+    LOG_ERROR("Internal error, envelope in illegal state");
     return;
 
   } else if (newPhase == Phase::Attack1) {
@@ -633,4 +633,40 @@ void TVF::_init_new_phase(enum Phase newPhase)
   _phase = newPhase;
 }
 
+
+void TVF::serialize(StateArchive &a)
+{
+  _serialize_envelope(a);
+
+  a.io(_sampleRate);
+  a.io(_lfo1FadeComplete);
+  a.io(_lfo2FadeComplete);
+  a.io(_lfo1Depth);
+  a.io(_lfo2Depth);
+  a.io(_L1Init);
+  a.io(_L2Init);
+  a.io(_L3Init);
+  a.io(_L4Init);
+  a.io(_L5Init);
+  a.io(_ipLevelInit);
+  a.io(_currentEnvTime);
+  a.io(_currentLevelInit);
+  a.io(_prevLevelInit);
+  a.io(_coFreqIndex);
+  a.io(_resIndexFreq);
+  a.io(_resIndexUsed);
+  a.io(_resonance);
+  a.io(_envDepth);
+  a.io(_envLevel);
+  a.io(_envLevelMode);
+  a.io(_prevEnvLevel);
+  a.io(_key);
+  a.io(_velocity);
+  a.io(_coFreqVSens);
+  a.io(_keyFollow);
+
+  if (_svf)                                  // Filter type is fixed by ROM
+    _svf->serialize(a);
+}
+
 }
@@ -37,9 +37,9 @@ namespace EmuSC {
 class TVF : public Envelope
 {
 public:
-  TVF(ControlRom::InstPartial &instPartial, uint8_t key, uint8_t velocity,
-      WaveGenerator *LFO1, WaveGenerator *LFO2, ControlRom::LookupTables &LUT,
-      Settings *settings, int8_t partId);
+  TVF(const ControlRom::InstPartial &instPartial, uint8_t key,
+      uint8_t velocity, WaveGenerator *LFO1, WaveGenerator *LFO2,
+      const ControlRom::LookupTables &LUT, Settings *settings, int8_t partId);
   ~TVF();
 
   void apply(float *sample);
@@ -48,6 +48,8 @@ public:
 
   void note_off();
 
+  void serialize(StateArchive &a);
+
 private:
   uint32_t _sampleRate;
 
@@ -59,8 +61,8 @@ private:
   int _lfo1Depth;
   int _lfo2Depth;
 
-  ControlRom::LookupTables &_LUT;
-  ControlRom::InstPartial &_instPartial;
+  const ControlRom::LookupTables &_LUT;
+  const ControlRom::InstPartial &_instPartial;
 
   int _L1Init;
   int _L2Init;
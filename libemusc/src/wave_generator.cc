@@ -46,6 +46,7 @@
 
 
 #include "wave_generator.h"
+#include "log.h"
 
 #include <algorithm>
 #include <cmath>
@@ -58,8 +59,8 @@
 namespace EmuSC {
 
 
-WaveGenerator::WaveGenerator(struct ControlRom::Instrument &instrument,
-                             struct ControlRom::LookupTables &LUT,
+WaveGenerator::WaveGenerator(const struct ControlRom::Instrument &instrument,
+                             const struct ControlRom::LookupTables &LUT,
                              Settings *settings, int partId)
   : _id(0),
     _LUT(LUT),
@@ -99,8 +100,8 @@ WaveGenerator::WaveGenerator(struct ControlRom::Instrument &instrument,
 }
 
 
-WaveGenerator::WaveGenerator(struct ControlRom::InstPartial &instPartial,
-                             struct ControlRom::LookupTables &LUT,
+WaveGenerator::WaveGenerator(const struct ControlRom::InstPartial &instPartial,
+                             const struct ControlRom::LookupTables &LUT,
                              Settings *settings, int partId)
   : _id(1),
     _LUT(LUT),
@@ -161,7 +162,7 @@ void WaveGenerator::update(void)
   // pre-caclculated and just needs to be added. Max rate is 0x28f6.
   int index = _instRate;
   if (_id == 0)
-    index += _settings->get_param(PatchParam::VibratoRate, _partId) - 0x40;
+    index += _settings->part_cache(_partId).vibratoRate;
 
   int rate =  _LUT.LFORate[std::clamp(index, 0, 127)];
   if (_id == 0)
@@ -184,8 +185,8 @@ void WaveGenerator::update(void)
     case Waveform::SampleHold: LFOValue = _generate_sample_hold(rate); break;
     case Waveform::Random:     LFOValue = _generate_random(rate);      break;
     default:
-      std::cerr << "libEmuSC: Internal error! Waveform generator called with "
-                << "illegal waveform ID: " << (int) _waveform << std::endl;
+      LOG_ERROR("Internal error! Waveform generator called with illegal "
+                "waveform ID: %d", (int) _waveform);
       return;
   }
 
@@ -275,7 +276,7 @@ int WaveGenerator::_generate_sample_hold(int rate)
   _accRate = (uint16_t) sum;
 
   if (overflow)
-    _random = (uint16_t) (rand() & 0xFFFF);
+    _random = (uint16_t) (_settings->part_prng(_partId).next() & 0xFFFF);
 
   return _random;
 }
@@ -291,7 +292,7 @@ int WaveGenerator::_generate_random(int rate)
 
   if (overflow || _randomFirstRun) {
     _randomFirstRun = false;
-    _random = (uint16_t) (rand() & 0xFFFF);
+    _random = (uint16_t) (_settings->part_prng(_partId).next() & 0xFFFF);
   }
 
   int result;
@@ -305,4 +306,22 @@ int WaveGenerator::_generate_random(int rate)
   return result;
 }
 
+
+void WaveGenerator::serialize(StateArchive &a)
+{
+  a.io(_id);
+  a.io(_waveform);
+  a.io(_instRate);
+  a.io(_rateChange);
+  a.io(_delay);
+  a.io(_delayIncLUT);
+  a.io(_fade);
+  a.io(_fadeIncLUT);
+  a.io(_currentValue);
+  a.io(_currentValueNorm);
+  a.io(_accRate);
+  a.io(_random);
+  a.io(_randomFirstRun);
+}
+
 }
@@ -44,13 +44,13 @@ public:
   };
 
   // LFO1 is defined in the Instrument section
-  WaveGenerator(struct ControlRom::Instrument &instrument,
-                struct ControlRom::LookupTables &LUT,
+  WaveGenerator(const struct ControlRom::Instrument &instrument,
+                const struct ControlRom::LookupTables &LUT,
                 Settings *settings, int partId);
 
   // LFO2s are defined in the Instrument Partial section
-  WaveGenerator(struct ControlRom::InstPartial &instPartial,
-                struct ControlRom::LookupTables &LUT,
+  WaveGenerator(const struct ControlRom::InstPartial &instPartial,
+                const struct ControlRom::LookupTables &LUT,
                 Settings *settings, int partId);
   ~WaveGenerator();
 
@@ -60,13 +60,15 @@ public:
 
   inline int fade(void) { return _fade; }
 
+  void serialize(StateArchive &a);
+
 private:
   WaveGenerator();
 
   bool _id;
   enum Waveform _waveform;
 
-  struct ControlRom::LookupTables &_LUT;
+  const struct ControlRom::LookupTables &_LUT;
 
   int _instRate;              // LFO Rate from instrument [partial] definition
   int _rateChange;            // Change in rate due to controller input etc.
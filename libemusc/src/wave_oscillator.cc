@@ -26,8 +26,8 @@
 namespace EmuSC {
 
 
-WaveOscillator::WaveOscillator(ControlRom::Sample *ctrlSample,
-                               std::vector<float> *pcmSamples,
+WaveOscillator::WaveOscillator(const ControlRom::Sample *ctrlSample,
+                               const std::vector<float> *pcmSamples,
                                std::function<void(void)> cb)
   : _pcmSamples(pcmSamples),
     _phase(0.0f),
@@ -78,6 +78,27 @@ void WaveOscillator::get_sample_set(Pitch *pitch, float pitchBend,
 }
 
 
+void WaveOscillator::skip_sample_set(Pitch *pitch, float pitchBend)
+{
+  _phase += pitchBend * pitch->skip_phase_increments(256) / 16384.0f;
+
+  int steps = static_cast<int>(_phase);
+  if (steps <= 0)
+    return;
+  _phase -= steps;
+
+  if (!_firstRunComplete && _index + steps - 1 >= _sampleEnd) {
+    _firstRunComplete = true;
+    if (_firstRunCompleteCallback) _firstRunCompleteCallback();
+  }
+
+  _index += steps;
+  if (_index > _sampleEnd)
+    _index = _loopStart + (_index - _sampleEnd - 1) % (_sampleEnd - _loopStart
+                                                       + 1);
+}
+
+
 float WaveOscillator::_fetch_sample(int index)
 {
   index = std::clamp(index, 0, (int) _pcmSamples->size() - 1);
@@ -113,4 +134,16 @@ float WaveOscillator::_interpolate()
 }
 
 
+void WaveOscillator::serialize(StateArchive &a)
+{
+  a.io(_sampleStart);
+  a.io(_sampleEnd);
+  a.io(_loopStart);
+  a.io(_loopLength);
+  a.io(_phase);
+  a.io(_index);
+  a.io(_loopMode);
+  a.io(_firstRunComplete);
+}
+
 } // namespace EmuSC
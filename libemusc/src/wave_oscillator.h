@@ -49,19 +49,25 @@ namespace EmuSC {
 class WaveOscillator
 {
 public:
-  WaveOscillator(ControlRom::Sample *ctrlSample, std::vector<float> *pcmSamples,
+  WaveOscillator(const ControlRom::Sample *ctrlSample,
+                 const std::vector<float> *pcmSamples,
                  std::function<void(void)> cb);
 
   void get_sample_set(Pitch *pitch, float pitchBend,
                       std::array<float, 256> &dryBus);
 
+  // Advance sample position by 256 samples without generating any output
+  void skip_sample_set(Pitch *pitch, float pitchBend);
+
+  void serialize(StateArchive &a);
+
 private:
   int _sampleStart;           // 0 or portamento offset if portamento is active
   int _sampleEnd;             // Sample set length
   int _loopStart;             // _sampleEnd - sample set loop length
   int _loopLength;            // Sample set loop length
 
-  std::vector<float> *_pcmSamples;
+  const std::vector<float> *_pcmSamples;
 
   float _phase;               // Phase fraction 0.0 - 1.0
   int _index;                 // Integer index
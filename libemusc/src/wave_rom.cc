@@ -27,7 +27,7 @@
 namespace EmuSC {
 
 
-WaveRom::WaveRom(std::vector<std::string> romPath, ControlRom &ctrlRom)
+WaveRom::WaveRom(std::vector<std::string> romPath, const ControlRom &ctrlRom)
 {
   std::vector<char> romData;
 
@@ -138,7 +138,7 @@ uint32_t WaveRom::_find_samples_rom_address(uint32_t address,
 
 
 int WaveRom::_read_samples(std::vector<char> &romData,
-                           struct ControlRom::Sample &ctrlSample,
+                           const struct ControlRom::Sample &ctrlSample,
                            enum ControlRom::SynthGen synthGen)
 {
   struct Samples s;
@@ -52,18 +52,19 @@ private:
   uint32_t _find_samples_rom_address(uint32_t address,
                                      enum ControlRom::SynthGen synthGen);
   int _read_samples(std::vector<char> &rom,
-                    struct ControlRom::Sample &ctrlSample,
+                    const struct ControlRom::Sample &ctrlSample,
                     enum ControlRom::SynthGen synthGen);
 
   WaveRom();
 
 public:
-  WaveRom(std::vector<std::string> romPath, ControlRom &ctrlRom);
+  WaveRom(std::vector<std::string> romPath, const ControlRom &ctrlRom);
 
-  inline struct Samples& samples(uint16_t ss) { return _sampleSets[ss]; }
+  // Sample data is read-only after loading and can be shared between threads
+  inline const struct Samples& samples(uint16_t ss) const { return _sampleSets[ss]; }
 
-  std::string version(void) { return _version; }
-  std::string date(void) { return _date; }
+  std::string version(void) const { return _version; }
+  std::string date(void) const { return _date; }
 };
 
 }